@@ -0,0 +1,89 @@
+// Axis.h
+#ifndef AXIS_H
+#define AXIS_H
+
+#include <Arduino.h>
+#include <math.h>
+
+#include "Units.h"
+#include "config.h"
+
+// Unit conversion and travel limits for one axis, fixed at compile time.
+// Template arguments must be integers, so the limits are given in
+// thousandths of a unit. The compiler turns them into whole steps and
+// micro-units, and every limit check is an integer compare.
+template <long StepsPerUnit, long MinMilli, long MaxMilli>
+class Axis
+{
+   public:
+    static constexpr long STEPS_PER_UNIT = StepsPerUnit;
+    static constexpr long MIN_STEPS = MinMilli * StepsPerUnit / 1000;
+    static constexpr long MAX_STEPS = MaxMilli * StepsPerUnit / 1000;
+    static constexpr long MIN_MICROS = MinMilli * (MICROS_PER_INCH / 1000);
+    static constexpr long MAX_MICROS = MaxMilli * (MICROS_PER_INCH / 1000);
+
+    static float toUnits(long steps)
+    {
+        return static_cast<float>(steps) / StepsPerUnit;
+    }
+    static long toSteps(float units) { return lroundf(units * StepsPerUnit); }
+    static long microsToSteps(long micros)
+    {
+        return ::microsToSteps(micros, StepsPerUnit);
+    }
+    static long stepsToMicros(long steps)
+    {
+        return ::stepsToMicros(steps, StepsPerUnit);
+    }
+
+    static bool atMin(long steps) { return steps <= MIN_STEPS; }
+    static bool atMax(long steps) { return steps >= MAX_STEPS; }
+    static bool atLimit(long steps) { return atMin(steps) || atMax(steps); }
+    static bool atLimit(long steps, bool positive)
+    {
+        return positive ? atMax(steps) : atMin(steps);
+    }
+    static long limitSteps(bool positive)
+    {
+        return positive ? MAX_STEPS : MIN_STEPS;
+    }
+
+    // Rotary axes: position within the turn (0 to StepsPerUnit - 1), whole
+    // turns from zero rounded towards minus infinity, and the shorter way
+    // from one position to another (half a turn goes forwards)
+    static long index(long steps)
+    {
+        long wrapped = steps % StepsPerUnit;
+        return wrapped < 0 ? wrapped + StepsPerUnit : wrapped;
+    }
+    static long turns(long steps)
+    {
+        return (steps - index(steps)) / StepsPerUnit;
+    }
+    static long shortestDelta(long fromSteps, long toSteps)
+    {
+        long delta = index(toSteps - fromSteps);
+        return delta > StepsPerUnit / 2 ? delta - StepsPerUnit : delta;
+    }
+
+    static long clampMicros(long micros)
+    {
+        if (micros < MIN_MICROS)
+        {
+            return MIN_MICROS;
+        }
+        if (micros > MAX_MICROS)
+        {
+            return MAX_MICROS;
+        }
+        return micros;
+    }
+};
+
+// The machine's axes. X and Y are in inches; rotation is in turns of the
+// table and has no travel limits.
+typedef Axis<X_STEPS_PER_INCH, 1000, 34000> XAxis;
+typedef Axis<Y_STEPS_PER_INCH, 1000, 36000> YAxis;
+typedef Axis<STEPS_PER_ROTATION, -1000000, 1000000> RotationAxis;
+
+#endif
@@ -22,10 +22,12 @@ class Command
     bool sprayOn;  // Whether spray should be on during movement
 
     // Default constructor
-    Command() : type('N'), value(0), sprayOn(false) {}
+    constexpr Command() : type('N'), value(0), sprayOn(false) {}
 
     // Regular constructor
-    Command(char t, float v, bool s) : type(t), value(v), sprayOn(s) {}
+    constexpr Command(char t, float v, bool s) : type(t), value(v), sprayOn(s)
+    {
+    }
 
     // Equality operator
     bool operator==(const Command& other) const
@@ -0,0 +1,61 @@
+// InputShaper.h
+#ifndef INPUT_SHAPER_H
+#define INPUT_SHAPER_H
+
+#include <Arduino.h>
+
+// Input shaper for one axis. The commanded position is convolved with a
+// short train of impulses (ZV: two, ZVD: three) spaced half a period of the
+// resonance apart, so the vibration excited by one impulse is cancelled by
+// the next. The shaped motion arrives later by half a period (ZV) or a full
+// one (ZVD) but never faster than commanded. Past positions are kept once
+// every few ticks and interpolated in between. update() runs from the step
+// interrupt.
+class InputShaper
+{
+   public:
+    enum Type
+    {
+        NONE,
+        ZV,
+        ZVD
+    };
+
+    InputShaper();
+
+    // Fails if the frequency or damping is out of range, or the shaper would
+    // need more history than it keeps
+    bool configure(Type type, float frequencyHz, float damping);
+    Type getType() const { return type; }
+    float getFrequency() const { return frequency; }
+    float getDamping() const { return dampingRatio; }
+    bool isEnabled() const { return type != NONE; }
+
+    void reset(long position);    // Forget the past, as if at rest here
+    long update(long commanded);  // Once per tick, returns the shaped position
+    bool isSettled() const
+    {
+        return idleTicks > delayTicks[impulses - 1] + DECIMATION;
+    }
+
+   private:
+    static const uint8_t MAX_IMPULSES = 3;
+    static const uint16_t HISTORY_SIZE = 256;  // Indexed by a wrapping uint8_t
+    static const uint8_t DECIMATION = 8;       // Ticks between samples
+
+    Type type;
+    float frequency;
+    float dampingRatio;
+
+    uint8_t impulses;
+    float amplitude[MAX_IMPULSES];
+    uint16_t delayTicks[MAX_IMPULSES];  // First impulse is always at 0
+
+    long history[HISTORY_SIZE];
+    uint8_t newest;       // Slot of the latest sample
+    uint8_t sinceSample;  // Ticks since it was taken
+    long lastCommanded;
+    uint16_t idleTicks;   // Ticks the command has held still, saturating
+};
+
+#endif
@@ -0,0 +1,145 @@
+// Interpolator.h
+#ifndef INTERPOLATOR_H
+#define INTERPOLATOR_H
+
+#include "StepperAxis.h"
+
+// Coordinated straight-line motion for up to MAX_AXES axes. One velocity
+// profile is planned along the path, measured in steps of the axis that
+// travels furthest (the major axis). The other axes follow it with Bresenham
+// error accumulation, so every axis starts, accelerates and arrives together.
+// The profile is a trapezoid, or an S-curve when a jerk limit is given.
+// A rate scale (the feed override) multiplies the cruise rate; changing it
+// mid-move ramps to the new rate at the path acceleration rather than
+// jumping. tick() is called from the step timer interrupt. The rate and the
+// step accumulator are 32-bit fixed point (2^32 = one step per tick), so a
+// trapezoid ramp or cruise only adds and compares each tick. S-curve easing
+// still works in floats, but only multiplies and adds, which the UNO R4's
+// FPU does in a cycle each. A move can be planned ahead with plan(), outside
+// the interrupt, and started later with start(), which only copies it in.
+class Interpolator
+{
+   public:
+    static const uint8_t MAX_AXES = 3;
+
+    // A planned move, ready for start()
+    struct Profile
+    {
+        long start[MAX_AXES];  // Axis positions the move was planned from
+        long deltas[MAX_AXES];
+        bool forward[MAX_AXES];
+        long totalSteps;  // 0 if already there
+        long decelerateAfter;
+        float rateScale;
+        float maxTickRate;
+        float nominalRate;
+        float minimumRate;
+        float cruiseRate;
+        float exitRate;
+        float floorRate;
+        float acceleration;
+        float jerk;
+        float jerkPerTick;
+        float easeScale;
+        float entryRate;
+        uint32_t entryFixed;
+        uint32_t cruiseFixed;
+        uint32_t floorFixed;
+        uint32_t accelPerTick;
+        bool valid;  // False if the limits allow no motion
+    };
+
+    explicit Interpolator(unsigned long tickFrequency);
+    void attachAxis(uint8_t index, StepperAxis* axis);
+
+    // Targets are absolute step positions. maxRates/accelerations are the
+    // per-axis limits in steps/s and steps/s^2; the path is slowed so that no
+    // axis exceeds its own limit. jerks (steps/s^3, may be null) ramp the
+    // acceleration in and out instead of switching it on and off.
+    // startRate/finishRate are major axis rates to start from and finish at,
+    // for blending into neighbouring moves. Call with the step interrupt
+    // held off.
+    bool begin(const long targets[], const float maxRates[],
+               const float accelerations[], const float jerks[] = nullptr,
+               float startRate = 0, float finishRate = 0);
+    // As begin(), but from the given start positions and rate scale into
+    // profile rather than the running move. Safe outside the interrupt.
+    bool plan(Profile& profile, const long starts[], const long targets[],
+              const float maxRates[], const float accelerations[],
+              const float jerks[], float startRate, float finishRate,
+              float scale) const;
+    // Run a planned move. Fails, leaving the running move alone, if the axes
+    // are no longer where it was planned from or the rate scale has changed.
+    bool start(const Profile& profile);
+    // Raise the finishing rate of the running move once the next move is
+    // known. Fails if braking has already begun.
+    bool setExitRate(float finishRate);
+    // Scale the cruise rate of this and later moves, 1 for as planned. The
+    // running move ramps to its new cruise rate unless already braking.
+    void setRateScale(float scale);
+    void stop();   // Decelerate to rest along the current line
+    void abort();  // Drop the move without decelerating
+    void tick();
+
+    bool isActive() const { return active; }
+    float getCurrentRate() const { return rate * stepsPerFixed; }
+    float getExitRate() const { return exitRate; }
+
+   private:
+    enum Phase
+    {
+        RAMPING,  // Toward the cruise rate, from above or below
+        CRUISING,
+        DECELERATING
+    };
+
+    StepperAxis* axes[MAX_AXES];
+    uint8_t axisCount;
+    float tickSeconds;
+    float fixedPerStep;   // Fixed-point rate of one step per second
+    float stepsPerFixed;  // And back
+    float maxTickRate;  // Fastest the moving axes' pulse timing allows
+
+    volatile bool active;
+    Phase phase;
+    long totalSteps;       // Major axis steps in the full line
+    long endStep;          // Major step where the move finishes
+    long stepsDone;        // Major steps emitted so far
+    long decelerateAfter;  // Major step where braking begins
+    long deltas[MAX_AXES];
+    bool forward[MAX_AXES];
+    long error[MAX_AXES];  // Bresenham accumulators
+
+    uint32_t rate;  // Current major axis rate, fixed point
+    float cruiseRate;
+    uint32_t cruiseFixed;
+    float nominalRate;  // Cruise rate before the rate scale
+    float rateScale;
+    float minimumRate;
+    float exitRate;   // Rate the move finishes at (0 to stop)
+    float floorRate;  // Slowest rate while braking
+    uint32_t floorFixed;
+    float acceleration;  // Major axis acceleration (steps/s^2)
+    uint32_t accelPerTick;  // Rate change per tick, fixed point
+    float jerk;          // Major axis jerk (steps/s^3), 0 for a trapezoid
+    float jerkPerTick;
+    float easeScale;     // 1 / 2j, so tick() never divides
+    float currentAccel;  // Signed, only tracked for S-curves
+    float easedRate;     // S-curve rate kept in floats, rate follows it
+    uint32_t stepPhase;  // Step accumulator, a carry out is one step
+
+    void emitStep();
+    uint32_t toFixed(float stepsPerSecond) const;
+    void setCruiseRate(float cruise);
+    void planBraking();
+    float rampSteps(float fromRate, float toRate) const;
+    static float rampSteps(float fromRate, float toRate, float accel,
+                           float jerkLimit);
+    // Highest rate up to peak that still ramps from fromRate and back down
+    // to landing within steps
+    static float fitPeak(float fromRate, float peak, float landing,
+                         long steps, float accel, float jerkLimit);
+    float easeToward(float targetRate);  // Rate change this tick (S-curve)
+};
+
+#endif
@@ -0,0 +1,85 @@
+// MotionQueue.h
+#ifndef MOTION_QUEUE_H
+#define MOTION_QUEUE_H
+
+#include <Arduino.h>
+
+#include "Interpolator.h"
+#include "config.h"
+
+// One planned straight-line move of the X/Y gantry
+struct MotionSegment
+{
+    long target[2];         // Absolute X/Y step targets
+    float maxRate[2];       // Per-axis speed limits (steps/s)
+    float acceleration[2];  // Per-axis acceleration limits (steps/s^2)
+    float jerk[2];          // Per-axis jerk limits (steps/s^3), 0 if none
+    bool sprayOn;           // Paint valve state for the whole segment
+    bool followsOverride;   // Scaled by the feed override (not homing)
+
+    // Spray window: with sprayWindow set, the valve is shut at the start and
+    // is open only while the major axis lies between these absolute step
+    // positions, so a pass can spray at cruise speed after a run-up
+    bool sprayWindow;
+    uint8_t sprayAxis;  // Major axis the positions are measured on
+    long sprayStartAt;  // Valve opens on reaching this step
+    long sprayStopAt;   // And closes on reaching this one
+
+    // Path geometry, filled in by the planner when the segment is queued
+    float length;         // Inches
+    float unit[2];        // Direction of travel
+    float inchesPerStep;  // Path length of one major axis step
+    float nominalSpeed;   // Path speed limit (inches/s)
+    float ceilingSpeed;   // Fastest the feed override may take it (inches/s)
+    float pathAccel;      // Path acceleration limit (inches/s^2)
+    float pathJerk;       // Path jerk limit (inches/s^3), 0 if none
+    float maxEntrySpeed;  // Corner speed allowed from the previous segment
+
+    // Velocity profile, planned in the main loop for these entry and exit
+    // conditions so the step interrupt only copies it in. If they no longer
+    // hold when the segment starts, the interrupt plans it afresh.
+    Interpolator::Profile profile;
+    float profileEntry;  // Path speed it starts from (inches/s)
+    bool profileExit;    // Carries into the segment queued behind it
+};
+
+// Ring buffer of planned segments between the pattern executor and the step
+// interrupt. Only the main loop pushes and only the interrupt pops, so the
+// head and tail indices each have a single writer.
+class MotionQueue
+{
+   public:
+    static const uint8_t CAPACITY = MOTION_QUEUE_SIZE;
+
+    MotionQueue();
+
+    bool push(const MotionSegment& segment);  // Main loop only
+    bool pop(MotionSegment& segment);         // Step interrupt only
+    const MotionSegment* peek() const;        // Step interrupt only
+    // Segment index places behind the oldest; call with the step interrupt
+    // held off and index below size()
+    const MotionSegment& at(uint8_t index) const
+    {
+        return buffer[static_cast<uint8_t>(tail + index) % CAPACITY];
+    }
+    MotionSegment& at(uint8_t index)
+    {
+        return buffer[static_cast<uint8_t>(tail + index) % CAPACITY];
+    }
+    void clear();  // Call with the step interrupt held off
+
+    uint8_t size() const { return static_cast<uint8_t>(head - tail); }
+    bool isEmpty() const { return head == tail; }
+    bool isFull() const { return size() >= CAPACITY; }
+
+    uint8_t getHighWater() const { return highWater; }
+    void resetHighWater() { highWater = size(); }
+
+   private:
+    MotionSegment buffer[CAPACITY];
+    volatile uint8_t head;  // Next slot to write, free-running
+    volatile uint8_t tail;  // Next slot to read, free-running
+    uint8_t highWater;      // Deepest the queue has been since reset
+};
+
+#endif
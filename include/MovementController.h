@@ -1,11 +1,15 @@
 #ifndef MOVEMENT_CONTROLLER_H
 #define MOVEMENT_CONTROLLER_H
 
-#include <AccelStepper.h>
-
 #include "Command.h"
+#include "InputShaper.h"
+#include "Interpolator.h"
+#include "MotionQueue.h"
 #include "ServoController.h"
 #include "StateManager.h"
+#include "StepTimer.h"
+#include "StepperAxis.h"
+#include "Units.h"
 
 class MovementController
 {
@@ -15,7 +19,13 @@ class MovementController
     void update();
 
     bool executeCommand(const Command& cmd);
-    bool isMoving() const;
+    // Queue a move of one axis to an absolute step position, the other axis
+    // staying where the last planned move left it. For compiled jobs, which
+    // have already been checked against the soft limits.
+    bool queueStepMove(bool isXAxis, long steps, bool sprayOn);
+    bool isMoving() const;  // Gantry or rotation
+    bool isGantryMoving() const;
+    bool isRotating() const;
     void stop();
 
     // Position control methods
@@ -27,10 +37,6 @@ class MovementController
     long getCurrentXSteps() const;
     long getCurrentYSteps() const;
 
-    // Unit conversion methods
-    float stepsToInches(long steps, long stepsPerInch) const;
-    float stepsToAngle(long steps) const;
-
     void setXSpeed(float acceleration);
     void setYSpeed(float acceleration);
 
@@ -38,6 +44,18 @@ class MovementController
     void setRotationSpeed(float speed);
     long getCurrentRotationSteps() const;
     float getCurrentRotationAngle() const;
+
+    // Table rotation is tracked in whole steps from the power-on position.
+    // Positions within the turn are 0 to STEPS_PER_ROTATION - 1, and these
+    // go there the shorter way unless that winds past the limit.
+    bool rotateToIndex(long indexSteps);
+    bool rotateToAngle(int degrees);
+    long getRotationTurns() const;
+    void setMaxWindTurns(int turns);  // 0 for no limit
+    int getMaxWindTurns() const
+    {
+        return static_cast<int>(maxWindSteps / STEPS_PER_ROTATION);
+    }
     void setStateManager(StateManager* manager) { stateManager = manager; }
 
     void setPatternSpeed(const String& pattern, float speedPercentage);
@@ -46,10 +64,51 @@ class MovementController
 
     float getCurrentXSpeed();
 
+    // Cycle time estimates in seconds, for moves as the planner runs them:
+    // trapezoids from rest to rest, stretched by the jerk limit when one is
+    // set, at the feed override. Painted X moves go at the pattern's speed,
+    // moves with the spray off at the rapid profile.
+    float estimateMoveSeconds(bool isXAxis, long steps, bool sprayOn,
+                              const String& pattern) const;
+    float estimateRapidSeconds(bool isXAxis, long steps) const;  // Spray off
+    float estimateRotationSeconds(long steps) const;
+    float estimateQueuedSeconds() const;  // Running segment and the queue
+    // Moves on whenever a pattern speed, the rapid profile, a jerk limit or
+    // the feed override is set, so cached estimates can tell they are stale
+    unsigned int getEstimateRevision() const { return estimateRevision; }
+
     bool startContinuousMovement(bool isXAxis, bool isPositive, float speed,
                                  float acceleration);
     bool startContinuousDiagonalMovement(bool xPositive, bool yPositive,
                                          float speed, float acceleration);
+
+    // Streamed jog for a pendant. Each packet gives signed X/Y speeds as a
+    // fraction of the axis speed (-1 to 1) and doubles as a heartbeat; the
+    // axes are only retargeted when a speed changes. Without a packet for
+    // JOG_HEARTBEAT_TIMEOUT_MS the jog brakes to a stop; the step interrupt
+    // keeps that deadline too, so a busy main loop cannot hold it off.
+    bool jog(float xFraction, float yFraction);
+    void jogHeartbeat();
+    bool isJogging() const { return jogActive; }
+
+    // Run-up and run-out, in inches, for the next sprayed X/Y move. The
+    // valve opens once the head is leadInches into the move and closes
+    // trailInches before its end, switched from the step interrupt.
+    void setSprayWindow(float leadInches, float trailInches);
+    // Lag of the paint valve, relay and gun together, in milliseconds. The
+    // window's switching steps are brought forward by the distance the head
+    // covers in that time at its current speed. Without a window, the valve
+    // still closes that much early at the end of the last sprayed segment.
+    void setValveLatency(float openMillis, float closeMillis);
+    // Proportional valve output. While spraying it runs at maxPercent, or
+    // when following the head it scales from minPercent at a standstill to
+    // maxPercent at the segment's planned speed, so the film stays even
+    // through the ramps at the ends of a pass.
+    void setSprayDuty(bool followSpeed, float minPercent, float maxPercent);
+    bool isSprayDutyFollowing() const { return sprayDutyFollows; }
+
+    // Straight-line move of X and Y together to an absolute position
+    bool moveToPosition(float xInches, float yInches);
     void toggleSpray(bool on);
 
     void setXHomed(bool homed) { xHomed = homed; }
@@ -63,21 +122,161 @@ class MovementController
 
     void setServoController(ServoController* servo) { servoController = servo; }
 
+    // Feed hold: pausing decelerates along the current path without
+    // blocking, and resuming continues the interrupted segment from wherever
+    // the head came to rest (once it has)
     void pauseExecution();   // New method to pause pattern execution
     void resumeExecution();  // New method to resume pattern execution
     bool isPaused() const { return executionPaused; }
 
+    // Look-ahead queue of planned X/Y segments. While streaming is set, the
+    // queue running dry between segments is counted as starvation.
+    void setStreaming(bool active);
+    bool isQueueFull() const { return motionQueue.isFull(); }
+    uint8_t getQueueDepth() const { return motionQueue.size(); }
+    uint8_t getQueueCapacity() const { return MotionQueue::CAPACITY; }
+    uint8_t getQueueHighWater() const { return motionQueue.getHighWater(); }
+    unsigned long getStarvationCount() const { return starvationCount; }
+    unsigned long getStarvedMillis() const;
+    void resetQueueStats();
+
+    // Jerk limit per axis in steps/s^3. Non-zero switches that axis from
+    // trapezoid ramps to S-curves.
+    void setJerk(bool isXAxis, float jerk);
+    float getJerk(bool isXAxis) const { return isXAxis ? xJerk : yJerk; }
+
+    // Speed and acceleration for moves made with the spray off, which have
+    // no finish to protect. Homing keeps its own speed.
+    void setRapidProfile(bool isXAxis, float speed, float acceleration);
+    float getRapidSpeed(bool isXAxis) const
+    {
+        return isXAxis ? xRapidSpeed : yRapidSpeed;
+    }
+    float getRapidAcceleration(bool isXAxis) const
+    {
+        return isXAxis ? xRapidAccel : yRapidAccel;
+    }
+
+    // Corner blending between queued segments; 0 stops at every corner
+    void setJunctionDeviation(float inches);
+    float getJunctionDeviation() const { return junctionDeviation; }
+
+    // Feed override in percent of the planned speed. Applies to the running
+    // segment, which ramps to the new speed, and to everything queued.
+    void setFeedOverride(float percent);
+    float getFeedOverride() const { return feedOverride * 100.0f; }
+
+    // Input shaping per axis, tuned to the resonance. Only changes while
+    // the axes are at rest; fails if moving or the tuning is out of range.
+    bool setInputShaper(bool isXAxis, InputShaper::Type type,
+                        float frequencyHz, float damping);
+    const InputShaper& getInputShaper(bool isXAxis) const
+    {
+        return isXAxis ? shaperX : shaperY;
+    }
+
+#ifdef STEP_TIMER_SIMULATED
+    StepTimer& getStepTimer() { return stepTimer; }
+#endif
+
    private:
-    AccelStepper stepperX;
-    AccelStepper stepperY;
-    AccelStepper stepperRotation;
+    StepperAxis stepperX;
+    StepperAxis stepperY;
+    StepperAxis stepperRotation;
+    InputShaper shaperX;
+    InputShaper shaperY;
     StateManager* stateManager;
 
+    // Coordinated X/Y lines share one velocity profile
+    Interpolator interpolator;
+    bool startInterpolatedMove(long xTarget, long yTarget, float xRate,
+                               float yRate, float xAccel, float yAccel);
+
+    MotionQueue motionQueue;
+    MotionSegment activeSegment;   // Segment the interpolator is running
+    volatile bool segmentRunning;  // Interpolator is working a queued segment
+    volatile bool streaming;
+    volatile bool starving;  // Queue ran dry mid-stream
+    volatile unsigned long starvationCount;
+    volatile unsigned long starvedTicks;
+
+    // End position of the last queued segment; relative moves build on it.
+    // Kept in micro-inches so repeated relative moves never drift, with the
+    // step positions they round to alongside.
+    long plannedXMicros;
+    long plannedYMicros;
+    long plannedXSteps;
+    long plannedYSteps;
+
+    // Junction planning. The last queued segment is kept so the next one can
+    // work out how fast it may take the corner between them.
+    float junctionDeviation;
+    float xJerk;
+    float yJerk;
+    float xRapidSpeed;
+    float yRapidSpeed;
+    float xRapidAccel;
+    float yRapidAccel;
+    volatile float feedOverride;  // 1 runs segments as planned
+    unsigned int estimateRevision;
+
+    long maxWindSteps;  // Rotation wind limit either way, 0 for none
+    bool windsTooFar(long from, long to) const;
+    MotionSegment lastQueued;
+    bool lastQueuedPending;
+    volatile float carrySpeed;  // Speed the running segment will finish at
+    volatile bool exitOpen;     // Running segment had nothing queued after it
+
+    // Spray window for the next sprayed segment, and the running one's state
+    enum SprayStage
+    {
+        SPRAY_WAITING,  // Before the window
+        SPRAY_OPEN,
+        SPRAY_DONE  // Past it, or no window
+    };
+    float sprayLead;
+    float sprayTrail;
+    volatile bool sprayWindowArmed;  // Valve follows the running segment
+    SprayStage sprayStage;
+    float valveOpenLag;   // Seconds from switching the relay to paint
+    float valveCloseLag;  // Seconds from switching it off to no paint
+    bool sprayDutyFollows;
+    float sprayDutyMin;  // Fractions of full duty
+    float sprayDutyMax;
+    int lastSprayDuty;  // Last value written to the PWM output
+    void updateSprayDuty();
+    void startSpray();
+    void trackSprayWindow();
+    bool reachedSprayStep(long at, float leadSteps) const;
+
+    bool queueMove(long xMicros, long yMicros, bool sprayOn);
+    bool queueSegment(long xTarget, long yTarget, bool sprayOn);
+    void planSegment(MotionSegment& segment, long fromX, long fromY);
+    float junctionSpeed(const MotionSegment& from,
+                        const MotionSegment& to) const;
+    float exitSpeedInto(const MotionSegment& next) const;
+    float overrideScale(const MotionSegment& segment) const;
+    void planProfile(MotionSegment& segment, const long from[],
+                     float entrySpeed, float exitSpeed) const;
+    void beginActiveSegment(float entrySpeed);
+    void startNextSegment();
+    void syncPlannedPosition();
+
+    // Step pulses are generated from the timer interrupt, not from loop()
+    StepTimer stepTimer;
+    static MovementController* stepOwner;
+    static void onStepTimer();
+    void serviceSteppers();
+    unsigned long lastServiceMicros;  // Polled fallback only
+
     float frontSpeed;
     float backSpeed;
     float leftSpeed;
     float rightSpeed;
     float lipSpeed;
+    float patternSpeed(const String& pattern) const;
+    float estimateAtSpeed(bool isXAxis, long steps, float speed,
+                          float accel) const;
 
     bool xHomed;
     bool yHomed;
@@ -91,6 +290,8 @@ class MovementController
     void updateSprayControl(const Command& cmd);
     void configureMotors();
     void updatePositionCache() const;  // Updates cached positions
+    bool isHoldSettled() const;
+    void finishResume();
 
     // Add member variables to track continuous movement
     bool continuousMovementActive;
@@ -101,12 +302,24 @@ class MovementController
     bool continuousDiagonalXPositive;
     bool continuousDiagonalYPositive;
 
-    void enforceXLimit(long& targetSteps);
-    void enforceYLimit(long& targetSteps);
+    bool jogActive;
+    float jogRate[2];  // Signed X/Y jog speeds (steps/s), 0 when braking
+    unsigned long lastJogPacket;
+    volatile unsigned long jogTicksLeft;  // Step interrupt's deadman count
+    volatile bool jogTimedOut;            // It ran out and braked the axes
+    void setJogRate(int axis, float rate);
+    void jogTimeout();
+    void updateJog();
+
+    // Clamp a planned micro-inch target to an axis' travel
+    template <typename AxisLimits>
+    void enforceLimit(long& targetMicros, long plannedMicros,
+                      bool homed) const;
 
     unsigned long lastPositionLog;
     const unsigned long POSITION_LOG_INTERVAL = 300;  // 300ms between logs
     bool isManualMovement() const;
+    bool isHoming() const;
 
     ServoController* servoController;
 
@@ -116,9 +329,9 @@ class MovementController
     float originalYAccel;
 
     bool executionPaused;
-    long pausedXPosition;
-    long pausedYPosition;
-    long pausedRotationPosition;
+    bool pausedSegmentPending;  // Interrupted segment to finish on resume
+    bool resumePending;         // Resume asked for while still braking
+    long pausedRotationTarget;
     float pausedXSpeed;
     float pausedYSpeed;
     float pausedRotationSpeed;
@@ -5,6 +5,7 @@
 #include "HomingController.h"
 #include "MovementController.h"
 #include "PatternSettings.h"
+#include "config.h"
 
 struct Offset
 {
@@ -28,9 +29,20 @@ class PatternExecutor
     PatternExecutor(MovementController& movement, HomingController& homing);
     void update();
 
-    void startPattern();
-    void startSingleSide(int side);
+    // Both refuse to start a job that would run past the soft limits
+    bool startPattern();
+    bool startSingleSide(int side);
+    // Walk the moves of one side, or of every enabled side when side is -1,
+    // and report the first target outside the travel limits
+    bool checkSoftLimits(int side);
     bool isExecuting() const;
+
+    // Cycle time in seconds for a job (side -1 for the full job) starting
+    // from the current head and table positions, and the time left on the
+    // running one. Moves, rotations and servo settling are counted; the
+    // homing at the end is not.
+    float estimateJobSeconds(int side) const;
+    float estimateRemainingSeconds() const;
     void stop();
 
     String getCurrentPatternName() const;
@@ -45,6 +57,7 @@ class PatternExecutor
         settings.initialOffsets.front.x = x;
         settings.initialOffsets.front.y = y;
         settings.initialOffsets.front.angle = angle;
+        settingsChanged();
     }
 
     void setBackOffsets(float x, float y, float angle)
@@ -52,6 +65,7 @@ class PatternExecutor
         settings.initialOffsets.back.x = x;
         settings.initialOffsets.back.y = y;
         settings.initialOffsets.back.angle = angle;
+        settingsChanged();
     }
 
     void setLeftOffsets(float x, float y, float angle)
@@ -59,6 +73,7 @@ class PatternExecutor
         settings.initialOffsets.left.x = x;
         settings.initialOffsets.left.y = y;
         settings.initialOffsets.left.angle = angle;
+        settingsChanged();
     }
 
     void setRightOffsets(float x, float y, float angle)
@@ -66,6 +81,7 @@ class PatternExecutor
         settings.initialOffsets.right.x = x;
         settings.initialOffsets.right.y = y;
         settings.initialOffsets.right.angle = angle;
+        settingsChanged();
     }
 
     void setLipOffsets(float x, float y, float angle)
@@ -73,12 +89,14 @@ class PatternExecutor
         settings.initialOffsets.lip.x = x;
         settings.initialOffsets.lip.y = y;
         settings.initialOffsets.lip.angle = angle;
+        settingsChanged();
     }
 
     void setGrid(int x, int y)
     {
         settings.rows.x = x;
         settings.rows.y = y;
+        settingsChanged();
     }
 
     void setEnabledSides(bool front, bool right, bool back, bool left, bool lip)
@@ -88,6 +106,7 @@ class PatternExecutor
         settings.enabledSides.back = back;
         settings.enabledSides.left = left;
         settings.enabledSides.lip = lip;
+        planValid = false;
     }
 
     bool isSideEnabled(int side) const
@@ -109,12 +128,31 @@ class PatternExecutor
         }
     }
 
+    void setRotationKeepOut(float xMin, float yMin, float xMax, float yMax)
+    {
+        settings.rotationKeepOut.xMin = xMin;
+        settings.rotationKeepOut.yMin = yMin;
+        settings.rotationKeepOut.xMax = xMax;
+        settings.rotationKeepOut.yMax = yMax;
+        planValid = false;
+    }
+
+    void setSprayRunUp(float inches)
+    {
+        settings.sprayRunUp = max(inches, 0.0f);
+        settingsChanged();
+    }
+
+    void setBuiltInPatterns(bool builtIn)
+    {
+        settings.builtInPatterns = builtIn;
+        settingsChanged();
+    }
+
     void setHorizontalTravel(float x, float y);
     void setVerticalTravel(float x, float y);
     void setLipTravel(float x, float y);
 
-    ~PatternExecutor();
-
    private:
     MovementController& movementController;
     HomingController& homingController;  // Changed to reference
@@ -125,23 +163,111 @@ class PatternExecutor
     bool executingSingleSide;
     bool stopped;
     int currentRow;
-    int currentRotation;
-    mutable int cachedPatternSide;  // Track which side's pattern is cached
 
     PatternSettings settings;
-    Command* generatePattern(int side) const;
+
+    // Order the sides of a job run in and the corner each starts from. A
+    // corner can start the passes from their far end and the rows from the
+    // last one; either way the side paints the same passes.
+    static const uint8_t FLIP_SWEEP = 1;
+    static const uint8_t FLIP_ROWS = 2;
+    struct JobPlan
+    {
+        int sides[5];
+        uint8_t corners[5];  // By side
+        int count;
+    };
+    JobPlan plan;
+    int planIndex;  // Place of the current side in the plan
+    // Order and corners with the least travel and rotation between sides,
+    // from the current head and table positions; side -1 plans every
+    // enabled side
+    JobPlan planJob(int side) const;
+
+    // The last plan made, kept like the job image so START, a single side
+    // and ESTIMATE search the side orders only after a setting or a speed
+    // changes, or when the job would start from elsewhere
+    mutable JobPlan cachedPlan;
+    mutable int cachedPlanSide;
+    // Head X and Y, table, table home, and the speeds' estimate revision
+    mutable long cachedPlanFrom[5];
+    mutable bool planValid;
+    const JobPlan& getPlan(int side) const;
+    // Seconds from painting one candidate side, by the corner it started
+    // from, to starting another at each corner; the planner's scratch
+    mutable float transitionCost[5][4][5][4];
+    float transitionSeconds(float fromX, float fromY, long fromTable,
+                            int side, uint8_t corner, bool singleSide) const;
+    void reportPlan();
+
+    // Commands are generated one at a time from the settings, so a side
+    // takes no memory whatever the grid size
+    Command commandAt(int side, int index, uint8_t corner) const;
     int calculatePatternSize(int side) const;
 
+    // Job image: every command of every side as its type, spray flag and
+    // absolute step target, compiled from the settings when a job starts
+    // and kept until one of them changes. Repeated parts replay it without
+    // generating or converting a command again. Each move is also timed
+    // once per start, for the planned order and the speeds then in force.
+    // A job too big for the image is generated as it runs instead.
+    struct JobStep
+    {
+        long target;    // Moves only
+        float seconds;  // Moves and servo settling
+        char type;      // As in Command
+        bool sprayOn;
+    };
+    JobStep jobImage[JOB_IMAGE_CAPACITY];
+    int sideImageStart[5];
+    int sideCommandCount[5];
+    uint8_t imageCorners[5];
+    bool jobImageValid;
+    void settingsChanged()  // Drops the job image and the plan
+    {
+        jobImageValid = false;
+        planValid = false;
+    }
+    void compileJob();
+    void timeJob(bool singleSide);
+
+    // Time left on a compiled job, kept without walking it: the current
+    // side's approach and painting less each move handed off, and by plan
+    // slot the time of the sides after it and of the table's return home,
+    // as timed at the start
+    float approachSecondsLeft;
+    float paintingSecondsLeft;
+    float laterSeconds[5];
+    void beginSideTiming();
+
     void reportStatus(const char* event, const String& details);
     float calculateMovementDuration(const Command& cmd) const;
 
-    Command* getCurrentPattern() const;
+    Command getCurrentCommand(int index) const;
+    // From the image, or generated with no target or time if not compiled
+    JobStep getCurrentStep(int index) const;
+    float getMoveValue(int index) const;  // Inches, as the command gives it
     int getCurrentPatternSize() const;
-    void processNextCommand();
+    bool isQueuedCommand(char type) const;
+    bool processNextCommand();  // True if the next command can follow at once
 
-    int calculateOptimalRotation(int targetRotation);
+    // Side changes: the servo and the move to the side's start (the first
+    // commands of every pattern) may run while the part is still rotating
+    static const int APPROACH_COMMANDS = 3;
+    bool overlapRotation;  // The current approach keeps clear of the part
+    bool rotateTo(int targetRotation);  // Degrees from the front
+    void getSideStart(int side, uint8_t corner, float& x, float& y) const;
+    void getSideFinish(int side, uint8_t corner, float& x, float& y) const;
+    float getSideAngle(int side) const;  // Servo angle
+    void getSideTravel(int side, float& x, float& y) const;
+    int getSideRows(int side) const;
+    bool findLimitViolation(int side, int& row, char& axis) const;
+    bool approachKeepsClear(float fromX, float fromY, float toX,
+                            float toY) const;
+    float estimateFrom(const JobPlan& job, int slot, int fromCommand,
+                       bool singleSide, long pos[2], long table) const;
 
-    mutable Command* currentPattern;
+    bool sprayArmed;  // Last SPRAY_ON/SPRAY_OFF seen while planning ahead
 };
 
 #endif
\ No newline at end of file
@@ -37,6 +37,27 @@ struct PatternSettings
         bool lip;
     } enabledSides;
 
+    // Area the gun must stay out of while the part rotates (inches). The
+    // move to the next side runs during the rotation only if it keeps clear.
+    // An empty area (max <= min) lets every move overlap.
+    struct
+    {
+        float xMin;
+        float yMin;
+        float xMax;
+        float yMax;
+    } rotationKeepOut;
+
+    // Distance each spray pass starts before and runs on past the painted
+    // area (inches), so the head crosses the edges at speed. The valve
+    // switches at the edges themselves.
+    float sprayRunUp;
+
+    // Paint every side from the fixed tables in Patterns.cpp instead of
+    // generating it from the offsets, travel and grid above. The tables
+    // start from the same corner every time and have no run-up.
+    bool builtInPatterns;
+
     // Constructor with default values
     PatternSettings()
     {
@@ -60,11 +81,18 @@ struct PatternSettings
         initialOffsets.left.y = 3.5 + 2.75;
         initialOffsets.left.angle = 90;
 
+        // Lip offsets, as in the fixed LIP table
+        initialOffsets.lip.x = 1.0;
+        initialOffsets.lip.y = 0 + 2.75;
+        initialOffsets.lip.angle = 90;
+
         // Travel distances
         travelDistance.horizontal.x = 26.49;
         travelDistance.horizontal.y = 4.16;
         travelDistance.vertical.x = 33.28;
         travelDistance.vertical.y = 4.415;
+        travelDistance.lip.x = 4.415;
+        travelDistance.lip.y = 27.49;
 
         // Default grid dimensions
         rows.x = 8;
@@ -76,6 +104,18 @@ struct PatternSettings
         enabledSides.back = true;
         enabledSides.left = true;
         enabledSides.lip = true;
+
+        // No keep-out area until one is set
+        rotationKeepOut.xMin = 0;
+        rotationKeepOut.yMin = 0;
+        rotationKeepOut.xMax = 0;
+        rotationKeepOut.yMax = 0;
+
+        // Passes start and end on the edges until a run-up is set
+        sprayRunUp = 0;
+
+        // Sides are generated from the settings unless the tables are chosen
+        builtInPatterns = false;
     }
 };
 
@@ -2,18 +2,44 @@
 #ifndef PATTERNS_H
 #define PATTERNS_H
 
+#include <stdint.h>
+
 #include "Command.h"
 
-extern Command FRONT[];
-extern Command BACK[];
-extern Command LEFT[];
-extern Command RIGHT[];
-extern Command LIP[];
+// Command packed into 32 bits for the built-in tables, which are const and
+// stay in flash: the value in ten-thousandths (the resolution moves are
+// planned to) in the low 24 bits, signed, then the type character and the
+// spray flag in the top bit. Values up to 838 inches or degrees either way.
+class PackedCommand
+{
+   public:
+    constexpr PackedCommand(const Command& cmd)
+        : bits((static_cast<uint32_t>(
+                    static_cast<int32_t>(cmd.value * 10000.0f +
+                                         (cmd.value < 0 ? -0.5f : 0.5f))) &
+                0xFFFFFFUL) |
+               (static_cast<uint32_t>(cmd.type & 0x7F) << 24) |
+               (cmd.sprayOn ? 0x80000000UL : 0))
+    {
+    }
+
+    Command unpack() const
+    {
+        // Shift the value up and back to extend its sign
+        int32_t value = static_cast<int32_t>(bits << 8) >> 8;
+        return Command(static_cast<char>((bits >> 24) & 0x7F),
+                       value / 10000.0f, (bits & 0x80000000UL) != 0);
+    }
+
+   private:
+    uint32_t bits;
+};
+
+static_assert(sizeof(PackedCommand) == 4, "PackedCommand must stay 4 bytes");
 
-extern const int FRONT_SIZE;
-extern const int BACK_SIZE;
-extern const int LEFT_SIZE;
-extern const int RIGHT_SIZE;
-extern const int LIP_SIZE;
+// Built-in pattern tables by side: 0 front, 1 back, 2 left, 3 right, 4 lip.
+// Out of range sides and indices give an empty table and a default command.
+int builtInPatternSize(int side);
+Command builtInPatternCommand(int side, int index);
 
-#endif
\ No newline at end of file
+#endif
@@ -40,6 +40,7 @@ class SerialCommandHandler
     const char* getStateString(SystemState state);
     void handleContinuousMovement(const String& command);
     void handleManualStop();
+    void handleJogCommand(const String& command);
     void handleContinuousDiagonalMovement(const String& command);
     void handleSprayToggle(const String& command);
     void handleServoCommand(const String& command);
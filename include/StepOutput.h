@@ -0,0 +1,52 @@
+// StepOutput.h
+#ifndef STEP_OUTPUT_H
+#define STEP_OUTPUT_H
+
+#include <Arduino.h>
+
+// One step or direction output, written straight to the port set/reset
+// registers on the UNO R4 so toggling it from the step interrupt costs a
+// single store instead of a digitalWrite() pin lookup. Host builds
+// (STEP_TIMER_SIMULATED) go through digitalWrite() so a mock can record and
+// timestamp every edge, unless the output is bound to registers directly,
+// which lets a test check the stores against a mock port.
+class StepOutput
+{
+   public:
+    explicit StepOutput(uint8_t pin);
+    StepOutput(volatile uint16_t* setRegister, volatile uint16_t* resetRegister,
+               uint16_t mask);
+
+#ifdef STEP_TIMER_SIMULATED
+    void set()
+    {
+        if (setRegister)
+        {
+            *setRegister = mask;
+            return;
+        }
+        digitalWrite(pin, HIGH);
+    }
+    void clear()
+    {
+        if (resetRegister)
+        {
+            *resetRegister = mask;
+            return;
+        }
+        digitalWrite(pin, LOW);
+    }
+#else
+    void set() { *setRegister = mask; }
+    void clear() { *resetRegister = mask; }
+#endif
+    void write(bool high) { high ? set() : clear(); }
+
+   private:
+    uint8_t pin;
+    volatile uint16_t* setRegister;    // POSR, writing a 1 drives the pin high
+    volatile uint16_t* resetRegister;  // PORR, writing a 1 drives it low
+    uint16_t mask;
+};
+
+#endif
@@ -0,0 +1,60 @@
+// StepTimer.h
+#ifndef STEP_TIMER_H
+#define STEP_TIMER_H
+
+#include <Arduino.h>
+
+#ifndef STEP_TIMER_SIMULATED
+#include <FspTimer.h>
+#endif
+
+// Periodic interrupt that drives step generation independently of loop().
+// On the UNO R4 this is a GPT/AGT channel configured through FspTimer. Host
+// builds define STEP_TIMER_SIMULATED and fire the ticks by hand with tick() or
+// advance(), so the step engine can be exercised without hardware.
+class StepTimer
+{
+   public:
+    typedef void (*Callback)();
+
+    StepTimer();
+    bool begin(unsigned long frequencyHz, Callback callback);
+    void end();
+
+    bool isRunning() const { return running; }
+    unsigned long getFrequency() const { return frequency; }
+    unsigned long getPeriodMicros() const { return 1000000UL / frequency; }
+    unsigned long getTickCount() const { return tickCount; }
+
+#ifdef STEP_TIMER_SIMULATED
+    void tick();                             // Fire a single timer period
+    void advance(unsigned long elapsedMicros);  // Fire every elapsed period
+#endif
+
+   private:
+    Callback callback;
+    unsigned long frequency;
+    bool running;
+    volatile unsigned long tickCount;
+
+#ifdef STEP_TIMER_SIMULATED
+    unsigned long pendingMicros;  // Elapsed time not yet turned into ticks
+#else
+    FspTimer timer;
+    static void isr(timer_callback_args_t* args);
+#endif
+
+    static StepTimer* instance;  // Timer that owns the interrupt vector
+    void fire();
+};
+
+// Holds off the step interrupt while the main loop changes stepper state.
+// Keep the scope short and never print to Serial while it is held.
+class StepTimerLock
+{
+   public:
+    StepTimerLock() { noInterrupts(); }
+    ~StepTimerLock() { interrupts(); }
+};
+
+#endif
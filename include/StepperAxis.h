@@ -0,0 +1,97 @@
+// StepperAxis.h
+#ifndef STEPPER_AXIS_H
+#define STEPPER_AXIS_H
+
+#include <Arduino.h>
+
+#include "InputShaper.h"
+#include "StepOutput.h"
+
+// Step/direction driver axis clocked by the step timer interrupt. Speeds and
+// accelerations are converted once, when set, into 32-bit fixed-point steps
+// per tick, so tick() only adds and compares: the speed moves by a fixed
+// increment each tick and a phase accumulator emits a step on every carry.
+// Braking starts once the steps left are no more than the steps it took to
+// accelerate. The interpolator can also pulse the axis directly with
+// stepOnce(). Pins are driven through the port registers. Pulses of a
+// couple of microseconds are raised and lowered on the same tick, so an axis
+// can step on every tick; longer ones are raised on one tick and lowered on
+// a later one. The direction pin only moves whole ticks after the last pulse
+// ended, to cover the driver's hold time, and a setup time too long to wait
+// out inside the interrupt puts the step off by whole ticks.
+// Positions and targets are the commanded motion and the motor follows it,
+// a step behind at most, or the shaped version of it when an input shaper
+// is attached.
+class StepperAxis
+{
+   public:
+    StepperAxis(uint8_t stepPin, uint8_t dirPin);
+
+    void setMaxSpeed(float stepsPerSecond);
+    float maxSpeed() const { return maxSpeedSteps; }
+    void setAcceleration(float stepsPerSecondSquared);
+    float acceleration() const { return accelerationSteps; }
+    void setPinsInverted(bool directionInvert);
+    // Driver timing in microseconds: step pulse width, direction setup before
+    // a step, and direction hold after the end of a pulse
+    void setDriverTiming(unsigned int pulseWidth, unsigned int dirSetup,
+                         unsigned int dirHold);
+    float maxStepRate() const;  // Fastest the pulse timing allows (steps/s)
+    void attachShaper(InputShaper* inputShaper);  // nullptr to detach
+
+    void moveTo(long absolute);
+    void move(long relative) { moveTo(position + relative); }
+    void stop();  // Decelerate to rest as quickly as the acceleration allows
+    long currentPosition() const { return position; }
+    // Where the motor is, behind currentPosition() while shaping
+    long motorStepPosition() const { return motorPosition; }
+    void setCurrentPosition(long newPosition);  // Also halts the axis
+    long targetPosition() const { return target; }
+    long distanceToGo() const { return target - position; }
+    bool isRunning() const;
+
+    void stepOnce(bool forwardStep);  // Single step, bypassing the ramp
+    void tick();                      // Called once per step timer tick
+
+   private:
+    StepOutput stepOutput;
+    StepOutput dirOutput;
+    bool invertDirection;
+
+    // Driver timing; pulseMicros is only used for pulses timed inline
+    unsigned int pulseMicros;
+    unsigned int setupMicros;
+    bool pulseEnded;  // A pulse ended this tick, leave the pins alone
+
+    // Limits as set, and as fixed point (2^32 = one step per tick)
+    float maxSpeedSteps;
+    float accelerationSteps;
+    uint32_t maxSpeedFixed;
+    uint32_t accelerationFixed;  // Speed change per tick
+    uint32_t minimumSpeedFixed;  // Creep speed for the last steps in
+
+    volatile long position;
+    volatile long target;
+    uint32_t speed;          // Current speed, fixed point
+    uint32_t phase;          // Step accumulator, a carry out is one step
+    long rampSteps;          // Steps needed to brake from the current speed
+    bool forward;            // Direction of the current move
+    bool pinForward;         // Direction currently driven on the dir pin
+    uint8_t pulseTicks;      // Ticks the step pin is held high, 0 inline
+    uint8_t pulseTicksLeft;  // Ticks until the current pulse ends
+    uint8_t setupTicks;      // Direction change to step, 0 if inline
+    uint8_t setupTicksLeft;  // Ticks until a step may follow it
+    uint8_t holdTicks;       // Pulse end to direction change
+    uint8_t holdTicksLeft;   // Ticks until the direction may change
+
+    // Shaping, if attached. motorPosition is where the motor really is.
+    InputShaper* shaper;
+    long motorPosition;
+
+    void advance(bool forwardStep);      // Commanded step
+    void followCommand(long commanded);  // Motor step toward it
+    void setDirection(bool forwardStep);
+    void pulse();
+};
+
+#endif
@@ -0,0 +1,52 @@
+// Units.h
+#ifndef UNITS_H
+#define UNITS_H
+
+#include <Arduino.h>
+#include <math.h>
+
+// Planned X/Y positions are carried as whole micro-inches, so relative moves
+// add up exactly no matter how many rows a job has. Step targets are always
+// derived from the absolute micro-inch position, rounding to the nearest
+// step, and a step count converts back to the same step count.
+const long MICROS_PER_INCH = 1000000L;
+
+// Largest distance converted, leaving room in a long of micro-inches to add
+// a relative move to any planned position. Homing asks for "as far as it
+// takes" with huge values, which clamp here.
+const float MAX_MICRO_INCHES = 1000.0;
+
+// Command values are resolved to 0.0001 inch. That is finer than one step on
+// either axis and exact for the decimal distances the patterns use.
+inline long inchesToMicros(float inches)
+{
+    inches = constrain(inches, -MAX_MICRO_INCHES, MAX_MICRO_INCHES);
+    return lroundf(inches * 10000.0f) * (MICROS_PER_INCH / 10000L);
+}
+
+inline float microsToInches(long micros)
+{
+    return static_cast<float>(micros) / MICROS_PER_INCH;
+}
+
+// Rounded integer division, half away from zero
+inline long roundedDivide(int64_t numerator, int64_t denominator)
+{
+    int64_t half = denominator / 2;
+    return static_cast<long>(numerator >= 0 ? (numerator + half) / denominator
+                                            : (numerator - half) / denominator);
+}
+
+inline long microsToSteps(long micros, long stepsPerInch)
+{
+    return roundedDivide(static_cast<int64_t>(micros) * stepsPerInch,
+                         MICROS_PER_INCH);
+}
+
+inline long stepsToMicros(long steps, long stepsPerInch)
+{
+    return roundedDivide(static_cast<int64_t>(steps) * MICROS_PER_INCH,
+                         stepsPerInch);
+}
+
+#endif
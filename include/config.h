@@ -18,6 +18,7 @@ const int SERVO_PIN = 12;
 
 const int PRESSURE_POT_RELAY = 15;
 const int PAINT_RELAY_PIN = 14;
+const int PAINT_VALVE_PWM_PIN = 9;  // Proportional valve, follows the relay
 const int WATER_DIVERSION_RELAY = 17;
 const int BACK_WASH_RELAY_PIN = 16;
 
@@ -30,6 +31,56 @@ const int X_STEPS_PER_INCH = 32;     // X-axis calibration
 const int Y_STEPS_PER_INCH = 85;     // Y-axis calibration
 const int STEPS_PER_ROTATION = 400;  // Steps for full rotation
 
+// Step generator interrupt rate. Every axis can step at most once per tick,
+// so this must stay above the fastest configured axis speed.
+const unsigned long STEP_TIMER_FREQUENCY_HZ = 10000;
+
+// Step driver timing in microseconds: step pulse width, direction setup
+// before a step and direction hold after one. Only pulses and setups of up
+// to 2us are timed inside the step interrupt, so an axis can step on every
+// tick; anything longer is rounded up to whole ticks.
+const unsigned int X_STEP_PULSE_MICROS = 10;
+const unsigned int X_DIR_SETUP_MICROS = 5;
+const unsigned int X_DIR_HOLD_MICROS = 5;
+const unsigned int Y_STEP_PULSE_MICROS = 10;
+const unsigned int Y_DIR_SETUP_MICROS = 5;
+const unsigned int Y_DIR_HOLD_MICROS = 5;
+const unsigned int ROTATION_STEP_PULSE_MICROS = 10;
+const unsigned int ROTATION_DIR_SETUP_MICROS = 5;
+const unsigned int ROTATION_DIR_HOLD_MICROS = 5;
+
+// Planned moves buffered ahead of the step interrupt (must be a power of two)
+const int MOTION_QUEUE_SIZE = 16;
+
+// Commands held in the compiled job image, 12 bytes each. Jobs with more
+// commands than this are generated as they run instead.
+const int JOB_IMAGE_CAPACITY = 256;
+
+// How far the path may deviate from a sharp corner between queued moves
+// (inches). Sets the speed carried through the corner; 0 stops at every one.
+const float JUNCTION_DEVIATION_INCHES = 0.02;
+
+// Feed override range, percent of the planned speed
+const float FEED_OVERRIDE_MIN_PERCENT = 10;
+const float FEED_OVERRIDE_MAX_PERCENT = 200;
+
+// Furthest the table may wind from its power-on position, in whole turns
+// either way (0 for no limit)
+const int ROTATION_MAX_WIND_TURNS = 0;
+
+// Paint valve lag from switching the relay to the spray starting or
+// stopping at the gun (ms). Spray windows switch early to make up for it.
+const float VALVE_OPEN_LATENCY_MS = 0;
+const float VALVE_CLOSE_LATENCY_MS = 0;
+
+// Proportional valve duty range (percent) when following the head speed.
+// The minimum is the flow at a standstill, the maximum at full speed.
+const float SPRAY_DUTY_MIN_PERCENT = 20;
+const float SPRAY_DUTY_MAX_PERCENT = 100;
+
+// A streamed jog brakes to a stop when no packet has arrived for this long
+const unsigned long JOG_HEARTBEAT_TIMEOUT_MS = 250;
+
 // Motor speeds and acceleration
 // Using extern to avoid multiple definition errors while keeping
 // configurability
@@ -39,6 +90,12 @@ extern int ROTATION_SPEED;  // Steps per second
 extern int X_ACCEL;         // Steps per second per second
 extern int Y_ACCEL;         // Steps per second per second
 extern int ROTATION_ACCEL;  // Steps per second per second
+extern int X_JERK;          // Steps per second cubed, 0 for trapezoid ramps
+extern int Y_JERK;          // Steps per second cubed, 0 for trapezoid ramps
+extern int X_RAPID_SPEED;   // Spray-off moves, steps per second
+extern int Y_RAPID_SPEED;   // Spray-off moves, steps per second
+extern int X_RAPID_ACCEL;   // Spray-off moves, steps per second per second
+extern int Y_RAPID_ACCEL;   // Spray-off moves, steps per second per second
 extern int HOMING_SPEED;    // Steps per seconds
 extern int ROTATION_HOMING_SPEED;
 
@@ -57,5 +114,6 @@ int ROTATION_ACCEL = 500;
 const int SERVO_MIN_ANGLE = 0;       // Minimum servo angle
 const int SERVO_MAX_ANGLE = 180;     // Maximum servo angle
 const int SERVO_DEFAULT_ANGLE = 90;  // Default starting position
+const int SERVO_SETTLE_MS = 15;      // Wait after each angle change
 
 #endif
\ No newline at end of file
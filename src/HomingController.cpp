@@ -1,6 +1,7 @@
 // HomingController.cpp
 #include "HomingController.h"
 
+#include "Axis.h"
 #include "config.h"
 
 HomingController::HomingController(MovementController& movement)
@@ -149,11 +150,12 @@ void HomingController::processRotationHoming()
             Serial.println(movementController.getCurrentRotationSteps());
             Serial.print(F("Initial rotation position: "));
             Serial.println(initialRotationPosition);
-            Serial.println(F("Sending absolute rotation command..."));
+            Serial.println(F("Sending rotation to home index..."));
 
-            // Create command to return to initial position using absolute steps
-            Command rotateCmd('R', initialRotationPosition, true);
-            bool cmdSuccess = movementController.executeCommand(rotateCmd);
+            // Rotation is tracked to the step, so homing only has to bring
+            // the table back to the same index, the shorter way round
+            bool cmdSuccess = movementController.rotateToIndex(
+                RotationAxis::index(initialRotationPosition));
 
             Serial.print(F("Command execution success: "));
             Serial.println(cmdSuccess ? "YES" : "NO");
@@ -189,11 +191,14 @@ void HomingController::processRotationHoming()
             Serial.println(F("=== Final Homing State Check ==="));
             Serial.print(F("Current position: "));
             Serial.println(movementController.getCurrentRotationSteps());
-            Serial.print(F("Target position: "));
-            Serial.println(initialRotationPosition);
-            Serial.print(F("Position difference: "));
-            Serial.println(abs(movementController.getCurrentRotationSteps() -
-                               initialRotationPosition));
+            Serial.print(F("Target index: "));
+            Serial.println(RotationAxis::index(initialRotationPosition));
+            Serial.print(F("Index difference: "));
+            Serial.println(RotationAxis::shortestDelta(
+                movementController.getCurrentRotationSteps(),
+                initialRotationPosition));
+            Serial.print(F("Turns wound: "));
+            Serial.println(movementController.getRotationTurns());
 
             homeComplete = true;
 
@@ -0,0 +1,118 @@
+// InputShaper.cpp
+#include "InputShaper.h"
+
+#include <math.h>
+
+#include "config.h"
+
+InputShaper::InputShaper()
+    : type(NONE),
+      frequency(0),
+      dampingRatio(0),
+      impulses(1),
+      newest(0),
+      sinceSample(0),
+      lastCommanded(0),
+      idleTicks(0)
+{
+    amplitude[0] = 1;
+    delayTicks[0] = 0;
+    reset(0);
+}
+
+bool InputShaper::configure(Type newType, float frequencyHz, float damping)
+{
+    if (newType == NONE)
+    {
+        type = NONE;
+        impulses = 1;
+        amplitude[0] = 1;
+        return true;
+    }
+    if (frequencyHz <= 0 || damping < 0 || damping >= 1)
+    {
+        return false;
+    }
+
+    // Impulses are half a damped period apart, weighted by the decay K of
+    // the ringing over that half period
+    float dampedRoot = sqrtf(1.0f - damping * damping);
+    float halfPeriod = 0.5f / (frequencyHz * dampedRoot);
+    float k = expf(-damping * PI / dampedRoot);
+    float halfTicks = halfPeriod * STEP_TIMER_FREQUENCY_HZ;
+
+    uint8_t count = newType == ZV ? 2 : 3;
+    float longest = halfTicks * (count - 1);
+    if (halfTicks < DECIMATION ||
+        longest > static_cast<float>(HISTORY_SIZE - 2) * DECIMATION)
+    {
+        return false;
+    }
+
+    type = newType;
+    frequency = frequencyHz;
+    dampingRatio = damping;
+    impulses = count;
+    if (type == ZV)
+    {
+        amplitude[0] = 1.0f / (1.0f + k);
+        amplitude[1] = k / (1.0f + k);
+    }
+    else
+    {
+        float sum = (1.0f + k) * (1.0f + k);
+        amplitude[0] = 1.0f / sum;
+        amplitude[1] = 2.0f * k / sum;
+        amplitude[2] = k * k / sum;
+    }
+    for (uint8_t i = 1; i < impulses; i++)
+    {
+        delayTicks[i] = static_cast<uint16_t>(lroundf(halfTicks * i));
+    }
+    return true;
+}
+
+void InputShaper::reset(long position)
+{
+    for (uint16_t i = 0; i < HISTORY_SIZE; i++)
+    {
+        history[i] = position;
+    }
+    sinceSample = 0;
+    lastCommanded = position;
+    idleTicks = 0xFFFF;
+}
+
+long InputShaper::update(long commanded)
+{
+    if (commanded != lastCommanded)
+    {
+        lastCommanded = commanded;
+        idleTicks = 0;
+    }
+    else if (idleTicks < 0xFFFF)
+    {
+        idleTicks++;
+    }
+
+    if (++sinceSample >= DECIMATION)
+    {
+        sinceSample = 0;
+        newest++;
+        history[newest] = commanded;
+    }
+
+    // Sum the delayed copies, interpolating between the two samples either
+    // side of each delay
+    float shaped = amplitude[0] * commanded;
+    for (uint8_t i = 1; i < impulses; i++)
+    {
+        uint16_t back = delayTicks[i] - sinceSample;
+        uint8_t slot = newest - static_cast<uint8_t>(back / DECIMATION);
+        float fraction = static_cast<float>(back % DECIMATION) / DECIMATION;
+        long newer = history[slot];
+        long older = history[static_cast<uint8_t>(slot - 1)];
+        shaped += amplitude[i] * (newer + (older - newer) * fraction);
+    }
+    return lroundf(shaped);
+}
@@ -0,0 +1,562 @@
+// Interpolator.cpp
+#include "Interpolator.h"
+
+#include <math.h>
+
+const float RATE_FIXED_ONE = 4294967296.0f;  // One step per tick
+
+Interpolator::Interpolator(unsigned long tickFrequency)
+    : axisCount(0),
+      tickSeconds(1.0f / tickFrequency),
+      fixedPerStep(RATE_FIXED_ONE / tickFrequency),
+      stepsPerFixed(tickFrequency / RATE_FIXED_ONE),
+      maxTickRate(tickFrequency / 2.0f),
+      active(false),
+      phase(RAMPING),
+      totalSteps(0),
+      endStep(0),
+      stepsDone(0),
+      decelerateAfter(0),
+      rate(0),
+      cruiseRate(0),
+      cruiseFixed(0),
+      nominalRate(0),
+      rateScale(1),
+      minimumRate(0),
+      exitRate(0),
+      floorRate(0),
+      floorFixed(0),
+      acceleration(0),
+      accelPerTick(0),
+      jerk(0),
+      jerkPerTick(0),
+      easeScale(0),
+      currentAccel(0),
+      easedRate(0),
+      stepPhase(0)
+{
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        axes[i] = nullptr;
+        deltas[i] = 0;
+        forward[i] = true;
+        error[i] = 0;
+    }
+}
+
+void Interpolator::attachAxis(uint8_t index, StepperAxis* axis)
+{
+    if (index >= MAX_AXES)
+    {
+        return;
+    }
+    axes[index] = axis;
+    if (index >= axisCount)
+    {
+        axisCount = index + 1;
+    }
+}
+
+bool Interpolator::begin(const long targets[], const float maxRates[],
+                         const float accelerations[], const float jerks[],
+                         float startRate, float finishRate)
+{
+    long starts[MAX_AXES];
+    for (uint8_t i = 0; i < axisCount; i++)
+    {
+        starts[i] = axes[i]->currentPosition();
+    }
+
+    Profile profile;
+    bool planned = plan(profile, starts, targets, maxRates, accelerations,
+                        jerks, startRate, finishRate, rateScale);
+    active = false;
+    exitRate = 0;
+    return planned && start(profile);
+}
+
+bool Interpolator::plan(Profile& profile, const long starts[],
+                        const long targets[], const float maxRates[],
+                        const float accelerations[], const float jerks[],
+                        float startRate, float finishRate, float scale) const
+{
+    long majorSteps = 0;
+    for (uint8_t i = 0; i < axisCount; i++)
+    {
+        long delta = targets[i] - starts[i];
+        profile.start[i] = starts[i];
+        profile.forward[i] = delta >= 0;
+        profile.deltas[i] = labs(delta);
+        if (profile.deltas[i] > majorSteps)
+        {
+            majorSteps = profile.deltas[i];
+        }
+    }
+
+    profile.totalSteps = majorSteps;
+    profile.rateScale = scale;
+    profile.valid = true;
+    if (majorSteps == 0)
+    {
+        return true;  // Already there
+    }
+
+    // Project each axis limit onto the major axis and keep the tightest.
+    // No axis steps more often than the major one, so the path rate is also
+    // held to the slowest pulse timing of the axes that move.
+    float tickLimit = 1.0f / tickSeconds;
+    float pathRate = tickLimit;
+    float pathAccel = 0;
+    float pathJerk = 0;
+    for (uint8_t i = 0; i < axisCount; i++)
+    {
+        if (profile.deltas[i] == 0)
+        {
+            continue;
+        }
+        float pulseLimit = axes[i]->maxStepRate();
+        if (pulseLimit < tickLimit)
+        {
+            tickLimit = pulseLimit;
+        }
+        float axisScale = static_cast<float>(majorSteps) / profile.deltas[i];
+        float axisRate = maxRates[i] * axisScale;
+        float axisAccel = accelerations[i] * axisScale;
+        if (axisRate < pathRate)
+        {
+            pathRate = axisRate;
+        }
+        if (pathAccel == 0 || axisAccel < pathAccel)
+        {
+            pathAccel = axisAccel;
+        }
+        float axisJerk = jerks ? jerks[i] * axisScale : 0;
+        if (axisJerk > 0 && (pathJerk == 0 || axisJerk < pathJerk))
+        {
+            pathJerk = axisJerk;
+        }
+    }
+    if (pathRate <= 0 || pathAccel <= 0)
+    {
+        profile.valid = false;
+        return false;
+    }
+    if (pathRate > tickLimit)
+    {
+        pathRate = tickLimit;
+    }
+    profile.nominalRate = pathRate;
+    pathRate *= scale;
+    if (pathRate > tickLimit)
+    {
+        pathRate = tickLimit;
+    }
+    float minimum = sqrtf(pathAccel * 0.5f);
+    if (minimum > pathRate)
+    {
+        minimum = pathRate;
+    }
+
+    // Ramp from the entry rate up to cruise and down to the exit rate. If the
+    // line is too short for that, lower the exit rate and then the peak
+    // until both ramps fit. Entering faster than a lowered override allows
+    // just ramps down to cruise, or brakes straight away on a short line.
+    float nominal = profile.nominalRate;
+    float entryLimit = nominal > pathRate ? nominal : pathRate;
+    startRate = constrain(startRate, minimum, entryLimit);
+    finishRate = constrain(finishRate, 0.0f, pathRate);
+    if (finishRate > startRate &&
+        rampSteps(startRate, finishRate, pathAccel, pathJerk) > majorSteps)
+    {
+        float low = startRate;
+        float high = finishRate;
+        for (uint8_t i = 0; i < 16; i++)
+        {
+            float mid = (low + high) / 2.0f;
+            if (rampSteps(startRate, mid, pathAccel, pathJerk) > majorSteps)
+            {
+                high = mid;
+            }
+            else
+            {
+                low = mid;
+            }
+        }
+        finishRate = low;
+    }
+    float landing = finishRate > minimum ? finishRate : minimum;
+    if (startRate < pathRate)
+    {
+        pathRate = fitPeak(startRate, pathRate, landing, majorSteps,
+                           pathAccel, pathJerk);
+    }
+
+    profile.maxTickRate = tickLimit;
+    profile.minimumRate = minimum;
+    profile.acceleration = pathAccel;
+    profile.jerk = pathJerk;
+    profile.accelPerTick = toFixed(pathAccel * tickSeconds);
+    if (profile.accelPerTick == 0)
+    {
+        profile.accelPerTick = 1;  // The move would never get moving
+    }
+    profile.jerkPerTick = pathJerk * tickSeconds;
+    profile.easeScale = pathJerk > 0 ? 0.5f / pathJerk : 0;
+    profile.cruiseRate = pathRate;
+    profile.cruiseFixed = toFixed(pathRate);
+    profile.exitRate = finishRate;
+    profile.entryRate = startRate;
+    profile.entryFixed = toFixed(startRate);  // Never below minimumRate
+
+    // Brake as planBraking() would from the first step
+    profile.floorRate = landing;
+    profile.floorFixed = toFixed(landing);
+    float current = profile.entryFixed * stepsPerFixed;
+    float peak = current > pathRate ? current : pathRate;
+    float brakingSteps =
+        rampSteps(peak, landing, pathAccel, pathJerk) + 1.0f;
+    profile.decelerateAfter = majorSteps - static_cast<long>(brakingSteps);
+    if (profile.decelerateAfter < 0)
+    {
+        profile.decelerateAfter = 0;
+    }
+    return true;
+}
+
+bool Interpolator::start(const Profile& profile)
+{
+    if (!profile.valid || profile.rateScale != rateScale)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < axisCount; i++)
+    {
+        if (axes[i]->currentPosition() != profile.start[i])
+        {
+            return false;
+        }
+    }
+
+    active = false;
+    exitRate = 0;
+    if (profile.totalSteps == 0)
+    {
+        return true;  // Already there
+    }
+
+    for (uint8_t i = 0; i < axisCount; i++)
+    {
+        deltas[i] = profile.deltas[i];
+        forward[i] = profile.forward[i];
+        error[i] = profile.totalSteps / 2;  // Round minor axes to nearest
+    }
+    totalSteps = profile.totalSteps;
+    endStep = profile.totalSteps;
+    stepsDone = 0;
+    decelerateAfter = profile.decelerateAfter;
+    maxTickRate = profile.maxTickRate;
+    nominalRate = profile.nominalRate;
+    minimumRate = profile.minimumRate;
+    acceleration = profile.acceleration;
+    accelPerTick = profile.accelPerTick;
+    jerk = profile.jerk;
+    jerkPerTick = profile.jerkPerTick;
+    easeScale = profile.easeScale;
+    currentAccel = 0;
+    cruiseRate = profile.cruiseRate;
+    cruiseFixed = profile.cruiseFixed;
+    exitRate = profile.exitRate;
+    floorRate = profile.floorRate;
+    floorFixed = profile.floorFixed;
+    rate = profile.entryFixed;
+    easedRate = profile.entryRate;
+    stepPhase = 0;
+    phase = RAMPING;
+    active = true;
+    return true;
+}
+
+bool Interpolator::setExitRate(float finishRate)
+{
+    if (!active || phase == DECELERATING)
+    {
+        return false;
+    }
+
+    // Never ask for more than the line can reach; at worst the move cruises
+    // the whole way at the planned peak
+    if (finishRate > cruiseRate)
+    {
+        finishRate = cruiseRate;
+    }
+    exitRate = finishRate;
+    planBraking();
+    return true;
+}
+
+void Interpolator::setRateScale(float scale)
+{
+    rateScale = scale;
+    if (!active || phase == DECELERATING)
+    {
+        return;
+    }
+
+    float target = constrain(nominalRate * scale, minimumRate, maxTickRate);
+    if (exitRate > target)
+    {
+        exitRate = target;
+    }
+    float current = getCurrentRate();
+    if (target > current)
+    {
+        // Only speed up as far as the rest of the line can brake from
+        float landing = exitRate > minimumRate ? exitRate : minimumRate;
+        target = fitPeak(current, target, landing, endStep - stepsDone,
+                         acceleration, jerk);
+    }
+    setCruiseRate(target);
+    planBraking();
+    phase = RAMPING;
+}
+
+float Interpolator::rampSteps(float fromRate, float toRate) const
+{
+    return rampSteps(fromRate, toRate, acceleration, jerk);
+}
+
+float Interpolator::rampSteps(float fromRate, float toRate, float accel,
+                              float jerkLimit)
+{
+    // Symmetric ramps average the two rates, so only the time is needed
+    float change = fabsf(toRate - fromRate);
+    float seconds;
+    if (jerkLimit <= 0)
+    {
+        seconds = change / accel;
+    }
+    else if (change * jerkLimit >= accel * accel)
+    {
+        seconds = change / accel + accel / jerkLimit;
+    }
+    else
+    {
+        seconds = 2.0f * sqrtf(change / jerkLimit);  // Never reaches full accel
+    }
+    return (fromRate + toRate) * 0.5f * seconds;
+}
+
+float Interpolator::fitPeak(float fromRate, float peak, float landing,
+                            long steps, float accel, float jerkLimit)
+{
+    if (rampSteps(fromRate, peak, accel, jerkLimit) +
+            rampSteps(peak, landing, accel, jerkLimit) <=
+        steps)
+    {
+        return peak;
+    }
+
+    float low = fromRate > landing ? fromRate : landing;
+    float high = peak;
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        float mid = (low + high) / 2.0f;
+        if (rampSteps(fromRate, mid, accel, jerkLimit) +
+                rampSteps(mid, landing, accel, jerkLimit) >
+            steps)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid;
+        }
+    }
+    return low;  // Equals fromRate if it can only brake
+}
+
+void Interpolator::planBraking()
+{
+    // Brake down to the rate the move really lands at, with a step to spare.
+    // Still settling down from above cruise counts from the current rate.
+    floorRate = exitRate > minimumRate ? exitRate : minimumRate;
+    floorFixed = toFixed(floorRate);
+    float current = getCurrentRate();
+    float peak = current > cruiseRate ? current : cruiseRate;
+    float brakingSteps = rampSteps(peak, floorRate) + 1.0f;
+    decelerateAfter = totalSteps - static_cast<long>(brakingSteps);
+    if (decelerateAfter < stepsDone)
+    {
+        decelerateAfter = stepsDone;
+    }
+}
+
+void Interpolator::stop()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    // Any acceleration still in progress has to unwind before braking
+    float current = getCurrentRate();
+    float unwind = jerk > 0 && currentAccel > 0
+                       ? current * currentAccel / jerk
+                       : 0;
+    long stopSteps = static_cast<long>(rampSteps(current, 0) + unwind) + 1;
+    if (stepsDone + stopSteps < endStep)
+    {
+        endStep = stepsDone + stopSteps;
+    }
+    decelerateAfter = stepsDone;
+    exitRate = 0;
+    floorRate = minimumRate;
+    floorFixed = toFixed(floorRate);
+    phase = DECELERATING;
+}
+
+void Interpolator::abort() { active = false; }
+
+void Interpolator::tick()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    if (phase != DECELERATING && stepsDone >= decelerateAfter)
+    {
+        phase = DECELERATING;
+    }
+
+    switch (phase)
+    {
+        case RAMPING:
+        {
+            bool rising = rate < cruiseFixed;
+            if (jerk > 0)
+            {
+                easedRate += easeToward(cruiseRate);
+                rate = toFixed(easedRate);
+            }
+            else if (rising)
+            {
+                // Stop at cruise rather than wrap past the top of the range
+                rate = cruiseFixed - rate > accelPerTick ? rate + accelPerTick
+                                                         : cruiseFixed;
+            }
+            else
+            {
+                rate = rate > accelPerTick ? rate - accelPerTick : 0;
+            }
+            if (rising ? rate >= cruiseFixed : rate <= cruiseFixed)
+            {
+                rate = cruiseFixed;
+                easedRate = cruiseRate;
+                currentAccel = 0;
+                phase = CRUISING;
+                if (!rising)
+                {
+                    planBraking();  // Was planned from the faster rate
+                }
+            }
+            break;
+        }
+        case CRUISING:
+            break;
+        case DECELERATING:
+            if (jerk > 0)
+            {
+                easedRate += easeToward(floorRate);
+                rate = toFixed(easedRate);
+            }
+            else
+            {
+                rate = rate > accelPerTick ? rate - accelPerTick : 0;
+            }
+            if (rate < floorFixed)
+            {
+                rate = floorFixed;  // Creep in on the last few steps
+                easedRate = floorRate;
+                currentAccel = 0;
+            }
+            break;
+    }
+
+    uint32_t previous = stepPhase;
+    stepPhase += rate;
+    if (stepPhase < previous)
+    {
+        emitStep();  // Carried out, one major step
+    }
+}
+
+float Interpolator::easeToward(float targetRate)
+{
+    // Ramp the acceleration toward its limit, and back toward zero early
+    // enough that the rate settles on the target instead of overshooting.
+    // A ramp at full jerk from currentAccel to 0 changes the rate by
+    // currentAccel^2 / 2j.
+    float remaining = targetRate - easedRate;
+    float direction = remaining >= 0 ? 1.0f : -1.0f;
+    float easing = currentAccel * currentAccel * easeScale;
+    if (currentAccel * direction > 0 && easing >= remaining * direction)
+    {
+        currentAccel -= direction * jerkPerTick;
+        if (currentAccel * direction < jerkPerTick)
+        {
+            currentAccel = direction * jerkPerTick;  // Keep creeping closer
+        }
+    }
+    else
+    {
+        currentAccel += direction * jerkPerTick;
+        if (currentAccel * direction > acceleration)
+        {
+            currentAccel = direction * acceleration;
+        }
+    }
+    return currentAccel * tickSeconds;
+}
+
+uint32_t Interpolator::toFixed(float stepsPerSecond) const
+{
+    // Axes whose pulses fit inside one tick may step on every tick, which
+    // is one past the top of the fixed-point range
+    if (stepsPerSecond <= 0)
+    {
+        return 0;
+    }
+    float fixed = stepsPerSecond * fixedPerStep + 0.5f;
+    if (fixed >= RATE_FIXED_ONE)
+    {
+        return UINT32_MAX;
+    }
+    return static_cast<uint32_t>(fixed);
+}
+
+void Interpolator::setCruiseRate(float cruise)
+{
+    cruiseRate = cruise;
+    cruiseFixed = toFixed(cruise);
+}
+
+void Interpolator::emitStep()
+{
+    stepsDone++;
+    for (uint8_t i = 0; i < axisCount; i++)
+    {
+        error[i] += deltas[i];
+        if (error[i] >= totalSteps)
+        {
+            error[i] -= totalSteps;
+            axes[i]->stepOnce(forward[i]);
+        }
+    }
+
+    if (stepsDone >= endStep)
+    {
+        active = false;
+        rate = 0;
+    }
+}
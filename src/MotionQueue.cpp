@@ -0,0 +1,46 @@
+// MotionQueue.cpp
+#include "MotionQueue.h"
+
+MotionQueue::MotionQueue() : head(0), tail(0), highWater(0) {}
+
+bool MotionQueue::push(const MotionSegment& segment)
+{
+    if (isFull())
+    {
+        return false;
+    }
+
+    buffer[head % CAPACITY] = segment;
+    __sync_synchronize();  // Publish only after the slot is written
+    head = head + 1;
+
+    if (size() > highWater)
+    {
+        highWater = size();
+    }
+    return true;
+}
+
+bool MotionQueue::pop(MotionSegment& segment)
+{
+    if (isEmpty())
+    {
+        return false;
+    }
+
+    segment = buffer[tail % CAPACITY];
+    __sync_synchronize();  // Release the slot only after it is copied
+    tail = tail + 1;
+    return true;
+}
+
+const MotionSegment* MotionQueue::peek() const
+{
+    if (isEmpty())
+    {
+        return nullptr;
+    }
+    return &buffer[tail % CAPACITY];
+}
+
+void MotionQueue::clear() { tail = head; }
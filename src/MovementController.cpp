@@ -1,29 +1,97 @@
 #include "MovementController.h"
 
 #include <Arduino.h>
+#include <math.h>
 
+#include "Axis.h"
 #include "config.h"
 
-const float MAX_X_TRAVEL_INCHES = 34.0;
-const float MAX_Y_TRAVEL_INCHES = 36.0;
-const float MIN_TRAVEL_INCHES = 1.0;
+MovementController* MovementController::stepOwner = nullptr;
+
+namespace
+{
+// Time to cover a distance from rest to rest. Each ramp of an S-curve
+// takes accel / jerk longer and loses half that from the cruise.
+float rampedMoveSeconds(float distance, float speed, float accel, float jerk)
+{
+    if (distance <= 0 || speed <= 0)
+    {
+        return 0;
+    }
+    if (accel <= 0)
+    {
+        return distance / speed;
+    }
+
+    float stretch = jerk > 0 ? accel / jerk : 0;
+    if (distance >= speed * speed / accel)
+    {
+        return distance / speed + speed / accel + stretch;
+    }
+    return 2.0f * sqrtf(distance / accel) + stretch;  // Never reaches speed
+}
+}  // namespace
 
 MovementController::MovementController()
-    : stepperX(AccelStepper::DRIVER, X_STEP_PIN, X_DIR_PIN),
-      stepperY(AccelStepper::DRIVER, Y_STEP_PIN, Y_DIR_PIN),
-      stepperRotation(AccelStepper::DRIVER, ROTATION_STEP_PIN,
-                      ROTATION_DIR_PIN),
-      motorsRunning(false),
+    : stepperX(X_STEP_PIN, X_DIR_PIN),
+      stepperY(Y_STEP_PIN, Y_DIR_PIN),
+      stepperRotation(ROTATION_STEP_PIN, ROTATION_DIR_PIN),
       stateManager(nullptr),
+      interpolator(STEP_TIMER_FREQUENCY_HZ),
+      segmentRunning(false),
+      streaming(false),
+      starving(false),
+      starvationCount(0),
+      starvedTicks(0),
+      plannedXMicros(0),
+      plannedYMicros(0),
+      plannedXSteps(0),
+      plannedYSteps(0),
+      junctionDeviation(JUNCTION_DEVIATION_INCHES),
+      xJerk(X_JERK),
+      yJerk(Y_JERK),
+      xRapidSpeed(X_RAPID_SPEED),
+      yRapidSpeed(Y_RAPID_SPEED),
+      xRapidAccel(X_RAPID_ACCEL),
+      yRapidAccel(Y_RAPID_ACCEL),
+      feedOverride(1),
+      estimateRevision(0),
+      maxWindSteps(static_cast<long>(ROTATION_MAX_WIND_TURNS) *
+                   STEPS_PER_ROTATION),
+      lastQueuedPending(false),
+      carrySpeed(0),
+      exitOpen(false),
+      sprayLead(0),
+      sprayTrail(0),
+      sprayWindowArmed(false),
+      sprayStage(SPRAY_DONE),
+      valveOpenLag(VALVE_OPEN_LATENCY_MS / 1000.0f),
+      valveCloseLag(VALVE_CLOSE_LATENCY_MS / 1000.0f),
+      sprayDutyFollows(false),
+      sprayDutyMin(SPRAY_DUTY_MIN_PERCENT / 100.0f),
+      sprayDutyMax(SPRAY_DUTY_MAX_PERCENT / 100.0f),
+      lastSprayDuty(-1),
+      lastServiceMicros(0),
       frontSpeed(X_SPEED),
       backSpeed(X_SPEED),
       leftSpeed(X_SPEED),
       rightSpeed(X_SPEED),
       xHomed(false),
       yHomed(false),
+      motorsRunning(false),
+      jogActive(false),
+      lastJogPacket(0),
+      jogTicksLeft(0),
+      jogTimedOut(false),
       lastPositionLog(0),
-      executionPaused(false)
+      executionPaused(false),
+      pausedSegmentPending(false),
+      resumePending(false)
 {
+    interpolator.attachAxis(0, &stepperX);
+    interpolator.attachAxis(1, &stepperY);
+    jogRate[0] = 0;
+    jogRate[1] = 0;
 }
 
 void MovementController::setup()
@@ -33,6 +101,674 @@ void MovementController::setup()
     // Ensure spray is off initially
     pinMode(PAINT_RELAY_PIN, OUTPUT);
     digitalWrite(PAINT_RELAY_PIN, HIGH);
+    pinMode(PAINT_VALVE_PWM_PIN, OUTPUT);
+    updateSprayDuty();
+
+    // Hand step pulse timing over to the timer interrupt
+    stepOwner = this;
+    if (!stepTimer.begin(STEP_TIMER_FREQUENCY_HZ, onStepTimer))
+    {
+        Serial.println(F("ERROR: Step timer unavailable, stepping from loop"));
+    }
+}
+
+void MovementController::onStepTimer()
+{
+    if (stepOwner)
+    {
+        stepOwner->serviceSteppers();
+    }
+}
+
+void MovementController::serviceSteppers()
+{
+    // Chain straight into the next planned segment without a loop() pass
+    if (!interpolator.isActive() && !executionPaused)
+    {
+        startNextSegment();
+    }
+    else if (exitOpen && !motionQueue.isEmpty())
+    {
+        // A segment arrived after the running one was planned to stop, so
+        // carry speed into it if braking has not started yet
+        exitOpen = false;
+        const MotionSegment& next = *motionQueue.peek();
+        if (next.sprayOn && !activeSegment.sprayWindow)
+        {
+            sprayWindowArmed = false;  // The paint carries on into it
+        }
+        float exitSpeed = exitSpeedInto(next);
+        if (interpolator.setExitRate(exitSpeed / activeSegment.inchesPerStep))
+        {
+            carrySpeed =
+                interpolator.getExitRate() * activeSegment.inchesPerStep;
+        }
+    }
+    if (starving)
+    {
+        starvedTicks++;
+    }
+
+    // Jog deadman, counted here so it holds however long loop() takes
+    if (jogTicksLeft > 0 && --jogTicksLeft == 0)
+    {
+        stepperX.stop();
+        stepperY.stop();
+        jogTimedOut = true;
+    }
+
+    // Axes first so pulses raised last tick end before new ones start
+    stepperX.tick();
+    stepperY.tick();
+    stepperRotation.tick();
+    interpolator.tick();
+
+    // Switch the valve on the exact step the spray window starts or ends
+    if (sprayWindowArmed)
+    {
+        trackSprayWindow();
+    }
+}
+
+void MovementController::startSpray()
+{
+    bool open = activeSegment.sprayOn;
+    sprayWindowArmed = false;
+    if (activeSegment.sprayWindow)
+    {
+        // Positions are absolute, so a segment resumed from part way along
+        // picks the window up from wherever the head is
+        const MotionSegment& segment = activeSegment;
+        bool done = segment.sprayStopAt == segment.sprayStartAt ||
+                    reachedSprayStep(segment.sprayStopAt, 0);
+        sprayStage = SPRAY_WAITING;
+        if (done)
+        {
+            sprayStage = SPRAY_DONE;
+        }
+        else if (reachedSprayStep(segment.sprayStartAt, 0))
+        {
+            sprayStage = SPRAY_OPEN;
+        }
+        sprayWindowArmed = !done;
+        open = sprayStage == SPRAY_OPEN;
+    }
+    else if (open && valveCloseLag > 0 && activeSegment.length > 0)
+    {
+        // Nothing sprayed follows, so rather than shut as the next segment
+        // starts, a latency late, close on the target less the lag
+        const MotionSegment* next = motionQueue.peek();
+        if (!next || !next->sprayOn)
+        {
+            MotionSegment& segment = activeSegment;
+            long x = stepperX.currentPosition();
+            long y = stepperY.currentPosition();
+            uint8_t axis =
+                labs(segment.target[0] - x) >= labs(segment.target[1] - y)
+                    ? 0
+                    : 1;
+            segment.sprayAxis = axis;
+            segment.sprayStartAt = axis == 0 ? x : y;
+            segment.sprayStopAt = segment.target[axis];
+            sprayStage = SPRAY_OPEN;
+            sprayWindowArmed = true;
+        }
+    }
+    digitalWrite(PAINT_RELAY_PIN, open ? LOW : HIGH);
+}
+
+void MovementController::trackSprayWindow()
+{
+    // Fire early by the distance the head covers while the valve responds
+    float rate = interpolator.isActive() ? interpolator.getCurrentRate() : 0;
+    if (sprayStage == SPRAY_WAITING &&
+        reachedSprayStep(activeSegment.sprayStartAt, rate * valveOpenLag))
+    {
+        sprayStage = SPRAY_OPEN;
+        digitalWrite(PAINT_RELAY_PIN, LOW);
+    }
+    if (sprayStage == SPRAY_OPEN &&
+        reachedSprayStep(activeSegment.sprayStopAt, rate * valveCloseLag))
+    {
+        sprayStage = SPRAY_DONE;
+        sprayWindowArmed = false;
+        digitalWrite(PAINT_RELAY_PIN, HIGH);
+    }
+}
+
+bool MovementController::reachedSprayStep(long at, float leadSteps) const
+{
+    const MotionSegment& segment = activeSegment;
+    uint8_t axis = segment.sprayAxis;
+    // The motor, not the command: shaping holds it back by up to the
+    // shaper's last impulse delay
+    long position = axis == 0 ? stepperX.motorStepPosition()
+                              : stepperY.motorStepPosition();
+    long lead = static_cast<long>(leadSteps);
+    return segment.target[axis] >= segment.sprayStartAt
+               ? position >= at - lead
+               : position <= at + lead;
+}
+
+void MovementController::startNextSegment()
+{
+    // The segment that just ended finished at carrySpeed
+    float entrySpeed = carrySpeed;
+    carrySpeed = 0;
+    exitOpen = false;
+
+    if (!motionQueue.pop(activeSegment))
+    {
+        sprayWindowArmed = false;
+        if (segmentRunning)
+        {
+            // A trailing SPRAY_OFF only rides on the next queued segment, so
+            // shut the valve here rather than leave it open while the queue
+            // is dry, through a rotation or past the end of the job. Only the
+            // relay is switched here; updateSprayDuty() in the main loop sees
+            // it closed and takes the PWM output to zero.
+            if (activeSegment.sprayOn)
+            {
+                digitalWrite(PAINT_RELAY_PIN, HIGH);
+            }
+            segmentRunning = false;
+            if (streaming)
+            {
+                starving = true;
+                starvationCount++;
+            }
+        }
+        return;
+    }
+
+    starving = false;
+    segmentRunning = true;
+    startSpray();
+    beginActiveSegment(entrySpeed);
+}
+
+void MovementController::beginActiveSegment(float entrySpeed)
+{
+    if (activeSegment.length <= 0)
+    {
+        interpolator.abort();  // Nothing to move
+        return;
+    }
+
+    // Plan to finish at the corner speed into whatever is queued next, or
+    // at rest if nothing is yet. The main loop has normally planned exactly
+    // that already; only a segment started from elsewhere, behind a late
+    // arrival or under a changed override is planned here.
+    const MotionSegment* next = motionQueue.peek();
+    interpolator.setRateScale(overrideScale(activeSegment));
+    bool planned = activeSegment.profileEntry == entrySpeed &&
+                   activeSegment.profileExit == (next != nullptr) &&
+                   interpolator.start(activeSegment.profile);
+    if (!planned)
+    {
+        float exitSpeed = next ? exitSpeedInto(*next) : 0;
+        float stepsPerInch = 1.0f / activeSegment.inchesPerStep;
+        interpolator.begin(activeSegment.target, activeSegment.maxRate,
+                           activeSegment.acceleration, activeSegment.jerk,
+                           entrySpeed * stepsPerInch,
+                           exitSpeed * stepsPerInch);
+    }
+    carrySpeed = interpolator.getExitRate() * activeSegment.inchesPerStep;
+    exitOpen = (next == nullptr);
+}
+
+float MovementController::overrideScale(const MotionSegment& segment) const
+{
+    if (!segment.followsOverride || segment.nominalSpeed <= 0)
+    {
+        return 1.0f;
+    }
+    return min(static_cast<float>(feedOverride),
+               segment.ceilingSpeed / segment.nominalSpeed);
+}
+
+float MovementController::exitSpeedInto(const MotionSegment& next) const
+{
+    // Never enter a segment faster than it could still stop from. An S-curve
+    // stop from v takes at most v^2/2a + v*a/j, so solve that for v.
+    float stoppable = sqrtf(2.0f * next.pathAccel * next.length);
+    if (next.pathJerk > 0)
+    {
+        float lag = next.pathAccel * next.pathAccel / next.pathJerk;
+        stoppable = sqrtf(lag * lag + stoppable * stoppable) - lag;
+    }
+    return min(next.maxEntrySpeed, stoppable);
+}
+
+void MovementController::planSegment(MotionSegment& segment, long fromX,
+                                     long fromY)
+{
+    float dx = XAxis::toUnits(segment.target[0] - fromX);
+    float dy = YAxis::toUnits(segment.target[1] - fromY);
+    long majorSteps = max(labs(segment.target[0] - fromX),
+                          labs(segment.target[1] - fromY));
+
+    segment.length = sqrtf(dx * dx + dy * dy);
+    segment.maxEntrySpeed = 0;
+    if (majorSteps == 0)
+    {
+        segment.unit[0] = 0;
+        segment.unit[1] = 0;
+        segment.inchesPerStep = 0;
+        segment.nominalSpeed = 0;
+        segment.ceilingSpeed = 0;
+        segment.pathAccel = 0;
+        segment.pathJerk = 0;
+        return;
+    }
+
+    segment.unit[0] = dx / segment.length;
+    segment.unit[1] = dy / segment.length;
+    segment.inchesPerStep = segment.length / majorSteps;
+
+    // Path limits are set by whichever axis reaches its own limit first.
+    // The feed override may raise a slower profile up to the axis' own
+    // configured speed, but never past it.
+    const float stepsPerInch[2] = {X_STEPS_PER_INCH, Y_STEPS_PER_INCH};
+    const float axisSpeed[2] = {static_cast<float>(X_SPEED),
+                                static_cast<float>(Y_SPEED)};
+    segment.nominalSpeed = 0;
+    segment.ceilingSpeed = 0;
+    segment.pathAccel = 0;
+    segment.pathJerk = 0;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        float component = fabsf(segment.unit[i]);
+        if (component < 1e-6f)
+        {
+            continue;
+        }
+        float speed = segment.maxRate[i] / stepsPerInch[i] / component;
+        float accel = segment.acceleration[i] / stepsPerInch[i] / component;
+        if (segment.nominalSpeed == 0 || speed < segment.nominalSpeed)
+        {
+            segment.nominalSpeed = speed;
+        }
+        float ceiling = max(segment.maxRate[i], axisSpeed[i]) /
+                        stepsPerInch[i] / component;
+        if (segment.ceilingSpeed == 0 || ceiling < segment.ceilingSpeed)
+        {
+            segment.ceilingSpeed = ceiling;
+        }
+        if (segment.pathAccel == 0 || accel < segment.pathAccel)
+        {
+            segment.pathAccel = accel;
+        }
+        float jerk = segment.jerk[i] / stepsPerInch[i] / component;
+        if (jerk > 0 && (segment.pathJerk == 0 || jerk < segment.pathJerk))
+        {
+            segment.pathJerk = jerk;
+        }
+    }
+}
+
+float MovementController::junctionSpeed(const MotionSegment& from,
+                                        const MotionSegment& to) const
+{
+    if (junctionDeviation <= 0 || from.length <= 0 || to.length <= 0)
+    {
+        return 0;
+    }
+
+    // Junction deviation: the fastest speed at which a circle that stays
+    // within junctionDeviation of the corner can be followed without
+    // exceeding the slower segment's acceleration
+    float cosTheta =
+        -(from.unit[0] * to.unit[0] + from.unit[1] * to.unit[1]);
+    float limit = min(from.nominalSpeed, to.nominalSpeed);
+    if (cosTheta > 0.999f)
+    {
+        return 0;  // Full reversal
+    }
+    if (cosTheta < -0.999f)
+    {
+        return limit;  // Straight through
+    }
+
+    float sinHalfTheta = sqrtf(0.5f * (1.0f - cosTheta));
+    float accel = min(from.pathAccel, to.pathAccel);
+    float speed = sqrtf(accel * junctionDeviation * sinHalfTheta /
+                        (1.0f - sinHalfTheta));
+    return min(speed, limit);
+}
+
+void MovementController::setJerk(bool isXAxis, float jerk)
+{
+    if (jerk < 0)
+    {
+        jerk = 0;
+    }
+    if (isXAxis)
+    {
+        xJerk = jerk;
+    }
+    else
+    {
+        yJerk = jerk;
+    }
+    estimateRevision++;
+}
+
+void MovementController::setRapidProfile(bool isXAxis, float speed,
+                                         float acceleration)
+{
+    if (speed <= 0 || acceleration <= 0)
+    {
+        return;
+    }
+    if (isXAxis)
+    {
+        xRapidSpeed = speed;
+        xRapidAccel = acceleration;
+    }
+    else
+    {
+        yRapidSpeed = speed;
+        yRapidAccel = acceleration;
+    }
+    estimateRevision++;
+}
+
+void MovementController::setJunctionDeviation(float inches)
+{
+    junctionDeviation = inches > 0 ? inches : 0;
+}
+
+bool MovementController::setInputShaper(bool isXAxis, InputShaper::Type type,
+                                        float frequencyHz, float damping)
+{
+    if (isMoving())
+    {
+        return false;
+    }
+
+    InputShaper& shaper = isXAxis ? shaperX : shaperY;
+    if (!shaper.configure(type, frequencyHz, damping))
+    {
+        return false;
+    }
+
+    // Unshaped axes skip the shaper entirely
+    StepTimerLock lock;
+    StepperAxis& axis = isXAxis ? stepperX : stepperY;
+    axis.attachShaper(shaper.isEnabled() ? &shaper : nullptr);
+    return true;
+}
+
+void MovementController::setFeedOverride(float percent)
+{
+    percent = constrain(percent, FEED_OVERRIDE_MIN_PERCENT,
+                        FEED_OVERRIDE_MAX_PERCENT);
+
+    StepTimerLock lock;
+    feedOverride = percent / 100.0f;
+    estimateRevision++;
+
+    // Queued segments pick the override up as they start; the running one
+    // ramps to it now and may have to finish slower than planned
+    if (segmentRunning && activeSegment.followsOverride)
+    {
+        interpolator.setRateScale(overrideScale(activeSegment));
+        carrySpeed = interpolator.getExitRate() * activeSegment.inchesPerStep;
+    }
+}
+
+void MovementController::setValveLatency(float openMillis, float closeMillis)
+{
+    StepTimerLock lock;
+    valveOpenLag = max(openMillis, 0.0f) / 1000.0f;
+    valveCloseLag = max(closeMillis, 0.0f) / 1000.0f;
+}
+
+void MovementController::setSprayDuty(bool followSpeed, float minPercent,
+                                      float maxPercent)
+{
+    sprayDutyFollows = followSpeed;
+    sprayDutyMax = constrain(maxPercent, 0.0f, 100.0f) / 100.0f;
+    sprayDutyMin = constrain(minPercent, 0.0f, maxPercent) / 100.0f;
+}
+
+void MovementController::updateSprayDuty()
+{
+    // The proportional valve only flows while the relay is open (active low)
+    float duty = 0;
+    if (digitalRead(PAINT_RELAY_PIN) == LOW)
+    {
+        duty = sprayDutyMax;
+        if (sprayDutyFollows)
+        {
+            float speed = 0;
+            float planned = 0;
+            {
+                StepTimerLock lock;
+                if (segmentRunning && interpolator.isActive())
+                {
+                    speed = interpolator.getCurrentRate() *
+                            activeSegment.inchesPerStep;
+                    planned = activeSegment.nominalSpeed *
+                              overrideScale(activeSegment);
+                }
+            }
+
+            // Full flow when there is no moving segment, such as priming
+            if (planned > 0)
+            {
+                float fraction = min(speed / planned, 1.0f);
+                duty = sprayDutyMin + (sprayDutyMax - sprayDutyMin) * fraction;
+            }
+        }
+    }
+
+    int value = lroundf(duty * 255.0f);
+    if (value != lastSprayDuty)
+    {
+        analogWrite(PAINT_VALVE_PWM_PIN, value);
+        lastSprayDuty = value;
+    }
+}
+
+void MovementController::setSprayWindow(float leadInches, float trailInches)
+{
+    sprayLead = max(leadInches, 0.0f);
+    sprayTrail = max(trailInches, 0.0f);
+}
+
+bool MovementController::queueMove(long xMicros, long yMicros, bool sprayOn)
+{
+    if (!queueSegment(XAxis::microsToSteps(xMicros),
+                      YAxis::microsToSteps(yMicros), sprayOn))
+    {
+        return false;
+    }
+    plannedXMicros = xMicros;
+    plannedYMicros = yMicros;
+    return true;
+}
+
+bool MovementController::queueStepMove(bool isXAxis, long steps, bool sprayOn)
+{
+    motorsRunning = true;
+    syncPlannedPosition();
+
+    long xTarget = isXAxis ? steps : plannedXSteps;
+    long yTarget = isXAxis ? plannedYSteps : steps;
+    long xMicros = plannedXMicros;
+    long yMicros = plannedYMicros;
+    if (!queueSegment(xTarget, yTarget, sprayOn))
+    {
+        return false;
+    }
+
+    // The moved axis is now exactly on a step; the other keeps its remainder
+    plannedXMicros = isXAxis ? XAxis::stepsToMicros(steps) : xMicros;
+    plannedYMicros = isXAxis ? yMicros : YAxis::stepsToMicros(steps);
+    return true;
+}
+
+bool MovementController::queueSegment(long xTarget, long yTarget, bool sprayOn)
+{
+    // Spray-off travel runs at the rapid profile rather than the side's
+    // painting speed
+    bool rapid = !sprayOn && !isHoming();
+
+    MotionSegment segment;
+    segment.target[0] = xTarget;
+    segment.target[1] = yTarget;
+    segment.maxRate[0] = rapid ? xRapidSpeed : stepperX.maxSpeed();
+    segment.maxRate[1] = rapid ? yRapidSpeed : stepperY.maxSpeed();
+    segment.acceleration[0] = rapid ? xRapidAccel : stepperX.acceleration();
+    segment.acceleration[1] = rapid ? yRapidAccel : stepperY.acceleration();
+    segment.jerk[0] = xJerk;
+    segment.jerk[1] = yJerk;
+    segment.sprayOn = sprayOn;
+    segment.followsOverride = !isHoming();
+    planSegment(segment, plannedXSteps, plannedYSteps);
+
+    // A run-up or run-out moves the valve switching inside the segment, to
+    // whole steps of the major axis
+    segment.sprayWindow = false;
+    if (sprayOn && (sprayLead > 0 || sprayTrail > 0) && segment.length > 0)
+    {
+        uint8_t axis = labs(xTarget - plannedXSteps) >=
+                               labs(yTarget - plannedYSteps)
+                           ? 0
+                           : 1;
+        long from = axis == 0 ? plannedXSteps : plannedYSteps;
+        long to = axis == 0 ? xTarget : yTarget;
+        float stepsPerInch = labs(to - from) / segment.length;
+        long lead = lroundf(min(sprayLead, segment.length) * stepsPerInch);
+        long trail = lroundf(min(sprayTrail, segment.length) * stepsPerInch);
+
+        segment.sprayWindow = true;
+        segment.sprayAxis = axis;
+        segment.sprayStartAt = to > from ? from + lead : from - lead;
+        segment.sprayStopAt = to > from ? to - trail : to + trail;
+        if (to > from ? segment.sprayStopAt < segment.sprayStartAt
+                      : segment.sprayStopAt > segment.sprayStartAt)
+        {
+            Serial.println(F("WARNING: Spray window shorter than the move"));
+            segment.sprayStopAt = segment.sprayStartAt;
+        }
+    }
+    sprayLead = 0;
+    sprayTrail = 0;
+    if (lastQueuedPending)
+    {
+        segment.maxEntrySpeed = junctionSpeed(lastQueued, segment);
+    }
+    if (motionQueue.isFull())
+    {
+        Serial.println(F("ERROR: Motion queue full"));
+        return false;
+    }
+
+    // Velocity profiles are planned here rather than in the step interrupt:
+    // the segment ahead again, now that it can carry speed into this one,
+    // then this one from that speed to rest
+    float entrySpeed = 0;
+    bool replanned = lastQueuedPending && lastQueued.length > 0;
+    if (replanned)
+    {
+        long from[2] = {lastQueued.profile.start[0],
+                        lastQueued.profile.start[1]};
+        planProfile(lastQueued, from, lastQueued.profileEntry,
+                    exitSpeedInto(segment));
+        lastQueued.profileExit = true;
+        if (lastQueued.profile.valid)
+        {
+            entrySpeed =
+                lastQueued.profile.exitRate * lastQueued.inchesPerStep;
+        }
+    }
+    long from[2] = {plannedXSteps, plannedYSteps};
+    planProfile(segment, from, entrySpeed, 0);
+    segment.profileExit = false;
+
+    {
+        // Once the segment ahead has started, the interrupt works out the
+        // speed to carry into this one itself
+        StepTimerLock lock;
+        uint8_t count = motionQueue.size();
+        if (replanned && count > 0)
+        {
+            MotionSegment& ahead = motionQueue.at(count - 1);
+            ahead.profile = lastQueued.profile;
+            ahead.profileExit = true;
+        }
+        motionQueue.push(segment);
+    }
+
+    plannedXSteps = xTarget;
+    plannedYSteps = yTarget;
+    lastQueued = segment;
+    lastQueuedPending = true;
+    return true;
+}
+
+void MovementController::planProfile(MotionSegment& segment,
+                                     const long from[], float entrySpeed,
+                                     float exitSpeed) const
+{
+    segment.profileEntry = entrySpeed;
+    segment.profile.valid = false;
+    if (segment.length <= 0)
+    {
+        return;
+    }
+
+    float stepsPerInch = 1.0f / segment.inchesPerStep;
+    interpolator.plan(segment.profile, from, segment.target, segment.maxRate,
+                      segment.acceleration, segment.jerk,
+                      entrySpeed * stepsPerInch, exitSpeed * stepsPerInch,
+                      overrideScale(segment));
+}
+
+void MovementController::syncPlannedPosition()
+{
+    StepTimerLock lock;
+    if (motionQueue.isEmpty() && !interpolator.isActive())
+    {
+        // Keep the sub-step remainder if the head ended where it was
+        // planned to; otherwise it was stopped, jogged or re-zeroed
+        if (stepperX.currentPosition() != plannedXSteps)
+        {
+            plannedXSteps = stepperX.currentPosition();
+            plannedXMicros = XAxis::stepsToMicros(plannedXSteps);
+        }
+        if (stepperY.currentPosition() != plannedYSteps)
+        {
+            plannedYSteps = stepperY.currentPosition();
+            plannedYMicros = YAxis::stepsToMicros(plannedYSteps);
+        }
+        lastQueuedPending = false;  // Next segment starts from rest
+    }
+}
+
+void MovementController::setStreaming(bool active)
+{
+    streaming = active;
+    if (!active)
+    {
+        starving = false;
+    }
+}
+
+unsigned long MovementController::getStarvedMillis() const
+{
+    return (starvedTicks * 1000UL) / STEP_TIMER_FREQUENCY_HZ;
+}
+
+void MovementController::resetQueueStats()
+{
+    StepTimerLock lock;
+    motionQueue.resetHighWater();
+    starvationCount = 0;
+    starvedTicks = 0;
 }
 
 void MovementController::configureMotors()
@@ -41,19 +777,23 @@ void MovementController::configureMotors()
     stepperX.setMaxSpeed(X_SPEED);
     stepperX.setAcceleration(X_ACCEL);
     stepperX.setPinsInverted(true);
-    stepperX.setMinPulseWidth(100);
+    stepperX.setDriverTiming(X_STEP_PULSE_MICROS, X_DIR_SETUP_MICROS,
+                             X_DIR_HOLD_MICROS);
 
     // Y-axis configuration
     stepperY.setMaxSpeed(Y_SPEED);
     stepperY.setAcceleration(Y_ACCEL);
     stepperY.setPinsInverted(false);
-    stepperY.setMinPulseWidth(100);
+    stepperY.setDriverTiming(Y_STEP_PULSE_MICROS, Y_DIR_SETUP_MICROS,
+                             Y_DIR_HOLD_MICROS);
 
     // Rotation configuration - keep current position as is
     stepperRotation.setMaxSpeed(ROTATION_SPEED);
     stepperRotation.setAcceleration(ROTATION_ACCEL);
     stepperRotation.setPinsInverted(false);
-    stepperRotation.setMinPulseWidth(100);
+    stepperRotation.setDriverTiming(ROTATION_STEP_PULSE_MICROS,
+                                    ROTATION_DIR_SETUP_MICROS,
+                                    ROTATION_DIR_HOLD_MICROS);
 }
 
 void MovementController::setPatternSpeed(const String& pattern,
@@ -75,6 +815,7 @@ void MovementController::setPatternSpeed(const String& pattern,
 
     // Convert percentage to actual speed (0-100% maps to 0-X_SPEED)
     float targetSpeed = (speedPercentage / 100.0) * X_SPEED;
+    estimateRevision++;
     // Serial.print(F("Calculated target speed: "));
     // Serial.println(targetSpeed);
 
@@ -114,6 +855,7 @@ void MovementController::setPatternSpeed(const String& pattern,
         if (stateManager && isPatternActive)
         {
             // Serial.println(F("Applying speed to X stepper (FRONT)"));
+            StepTimerLock lock;
             stepperX.setMaxSpeed(targetSpeed);
             // Serial.print(F("Verified X stepper speed: "));
             // Serial.println(stepperX.maxSpeed());
@@ -130,6 +872,7 @@ void MovementController::setPatternSpeed(const String& pattern,
         if (stateManager && isPatternActive)
         {
             // Serial.println(F("Applying speed to X stepper (BACK)"));
+            StepTimerLock lock;
             stepperX.setMaxSpeed(targetSpeed);
             // Serial.print(F("Verified X stepper speed: "));
             // Serial.println(stepperX.maxSpeed());
@@ -146,6 +889,7 @@ void MovementController::setPatternSpeed(const String& pattern,
         if (stateManager && isPatternActive)
         {
             // Serial.println(F("Applying speed to X stepper (LEFT)"));
+            StepTimerLock lock;
             stepperX.setMaxSpeed(targetSpeed);
             // Serial.print(F("Verified X stepper speed: "));
             // Serial.println(stepperX.maxSpeed());
@@ -162,6 +906,7 @@ void MovementController::setPatternSpeed(const String& pattern,
         if (stateManager && isPatternActive)
         {
             // Serial.println(F("Applying speed to X stepper (RIGHT)"));
+            StepTimerLock lock;
             stepperX.setMaxSpeed(targetSpeed);
             // Serial.print(F("Verified X stepper speed: "));
             // Serial.println(stepperX.maxSpeed());
@@ -173,6 +918,7 @@ void MovementController::setPatternSpeed(const String& pattern,
 
         if (stateManager && isPatternActive)
         {
+            StepTimerLock lock;
             stepperX.setMaxSpeed(targetSpeed);
         }
     }
@@ -185,52 +931,65 @@ void MovementController::setPatternSpeed(const String& pattern,
     // Serial.println(F("--- setPatternSpeed Debug End ---"));
 }
 
-void MovementController::applyPatternSpeed(const String& pattern)
+float MovementController::patternSpeed(const String& pattern) const
 {
     if (pattern == "FRONT")
     {
-        stepperX.setMaxSpeed(frontSpeed);
+        return frontSpeed;
     }
-    else if (pattern == "BACK")
+    if (pattern == "BACK")
     {
-        stepperX.setMaxSpeed(backSpeed);
+        return backSpeed;
     }
-    else if (pattern == "LEFT")
+    if (pattern == "LEFT")
     {
-        stepperX.setMaxSpeed(leftSpeed);
+        return leftSpeed;
     }
-    else if (pattern == "RIGHT")
+    if (pattern == "RIGHT")
     {
-        stepperX.setMaxSpeed(rightSpeed);
+        return rightSpeed;
     }
-    else if (pattern == "LIP")
+    if (pattern == "LIP")
     {
-        stepperX.setMaxSpeed(lipSpeed);
+        return lipSpeed;
     }
+    return stepperX.maxSpeed();  // Not a pattern, keep the current speed
+}
+
+void MovementController::applyPatternSpeed(const String& pattern)
+{
+    StepTimerLock lock;
+    stepperX.setMaxSpeed(patternSpeed(pattern));
 }
 
 void MovementController::resetToDefaultSpeed()
 {
+    StepTimerLock lock;
     stepperX.setMaxSpeed(X_SPEED);
 }
 
 void MovementController::updatePositionCache() const
 {
+    StepTimerLock lock;
     // Const cast is safe here because we're only reading values
-    lastXPos = const_cast<AccelStepper&>(stepperX).currentPosition();
-    lastYPos = const_cast<AccelStepper&>(stepperY).currentPosition();
+    lastXPos = const_cast<StepperAxis&>(stepperX).currentPosition();
+    lastYPos = const_cast<StepperAxis&>(stepperY).currentPosition();
     lastRotationPos =
-        const_cast<AccelStepper&>(stepperRotation).currentPosition();
+        const_cast<StepperAxis&>(stepperRotation).currentPosition();
 }
 
 void MovementController::setRotationPosition(long position)
 {
-    stepperRotation.setCurrentPosition(position);
+    {
+        StepTimerLock lock;
+        stepperRotation.setCurrentPosition(position);
+    }
     updatePositionCache();
 }
 
 void MovementController::setRotationSpeed(float speed)
 {
+    StepTimerLock lock;
     stepperRotation.setMaxSpeed(speed);
 }
 
@@ -241,12 +1000,62 @@ long MovementController::getCurrentRotationSteps() const
 
 float MovementController::getCurrentRotationAngle() const
 {
-    return stepsToAngle(lastRotationPos);
+    return RotationAxis::toUnits(lastRotationPos) * 360.0f;
+}
+
+bool MovementController::rotateToIndex(long indexSteps)
+{
+    // Plan from where the table is headed, so a rotation still running
+    // counts as done
+    long from = stepperRotation.targetPosition();
+    long delta = RotationAxis::shortestDelta(from, indexSteps);
+    if (2 * labs(delta) == STEPS_PER_ROTATION &&
+        labs(from - delta) < labs(from + delta))
+    {
+        delta = -delta;  // Half a turn either way, so unwind
+    }
+    if (delta != 0 && windsTooFar(from, from + delta))
+    {
+        // The long way round unwinds instead
+        delta += delta > 0 ? -STEPS_PER_ROTATION : STEPS_PER_ROTATION;
+        if (windsTooFar(from, from + delta))
+        {
+            Serial.println(F("ERROR: Rotation would pass the wind limit"));
+            return false;
+        }
+    }
+
+    {
+        StepTimerLock lock;
+        stepperRotation.moveTo(from + delta);
+    }
+    Serial.print(F("Rotating to index "));
+    Serial.print(RotationAxis::index(from + delta));
+    Serial.print(F(", turn "));
+    Serial.println(RotationAxis::turns(from + delta));
+    return true;
+}
+
+bool MovementController::rotateToAngle(int degrees)
+{
+    return rotateToIndex(roundedDivide(
+        static_cast<int64_t>(degrees) * STEPS_PER_ROTATION, 360));
 }
 
-float MovementController::stepsToAngle(long steps) const
+long MovementController::getRotationTurns() const
 {
-    return (static_cast<float>(steps) * 360.0) / STEPS_PER_ROTATION;
+    return RotationAxis::turns(lastRotationPos);
+}
+
+void MovementController::setMaxWindTurns(int turns)
+{
+    maxWindSteps = static_cast<long>(abs(turns)) * STEPS_PER_ROTATION;
+}
+
+bool MovementController::windsTooFar(long from, long to) const
+{
+    // Past the limit, moves that unwind are still allowed
+    return maxWindSteps > 0 && labs(to) > maxWindSteps && labs(to) > labs(from);
 }
 
 bool MovementController::executeCommand(const Command& cmd)
@@ -273,47 +1082,60 @@ bool MovementController::executeCommand(const Command& cmd)
     motorsRunning = true;
 
     long targetSteps = 0;
-    float targetPosition = 0.0;
+    long targetMicros = 0;
+
+    // X/Y moves are queued as segments that start from the end of the last
+    // planned move, or from the current position when nothing is pending
+    syncPlannedPosition();
 
     switch (cmd.type)
     {
         case 'X':  // Relative X movement
-            targetSteps = getCurrentXSteps() + (cmd.value * X_STEPS_PER_INCH);
-            enforceXLimit(targetSteps);
-            stepperX.moveTo(targetSteps);
-            break;
+            targetMicros = plannedXMicros + inchesToMicros(cmd.value);
+            enforceLimit<XAxis>(targetMicros, plannedXMicros, xHomed);
+            return queueMove(targetMicros, plannedYMicros, cmd.sprayOn);
 
         case 'Y':  // Relative Y movement
-            targetSteps = getCurrentYSteps() + (cmd.value * Y_STEPS_PER_INCH);
-            enforceYLimit(targetSteps);
-            stepperY.moveTo(targetSteps);
-            break;
+            targetMicros = plannedYMicros + inchesToMicros(cmd.value);
+            enforceLimit<YAxis>(targetMicros, plannedYMicros, yHomed);
+            return queueMove(plannedXMicros, targetMicros, cmd.sprayOn);
 
         case 'M':  // Absolute X movement
-            targetSteps = cmd.value * X_STEPS_PER_INCH;
-            enforceXLimit(targetSteps);
-            stepperX.moveTo(targetSteps);
-            break;
+            targetMicros = inchesToMicros(cmd.value);
+            enforceLimit<XAxis>(targetMicros, plannedXMicros, xHomed);
+            return queueMove(targetMicros, plannedYMicros, cmd.sprayOn);
 
         case 'N':  // Absolute Y movement
-            targetSteps = cmd.value * Y_STEPS_PER_INCH;
-            enforceYLimit(targetSteps);
-            stepperY.moveTo(targetSteps);
-            break;
+            targetMicros = inchesToMicros(cmd.value);
+            enforceLimit<YAxis>(targetMicros, plannedYMicros, yHomed);
+            return queueMove(plannedXMicros, targetMicros, cmd.sprayOn);
 
         case 'R':  // Rotation movement (in degrees)
         {
             // Convert degrees to steps
-            targetSteps = (cmd.value * STEPS_PER_ROTATION) / 360;
+            targetSteps = RotationAxis::toSteps(cmd.value / 360.0f);
+            long from = stepperRotation.targetPosition();
+            long to = cmd.sprayOn ? targetSteps : from + targetSteps;
+            if (windsTooFar(from, to))
+            {
+                Serial.println(F("ERROR: Rotation would pass the wind limit"));
+                return false;
+            }
             if (cmd.sprayOn)  // If absolute positioning
             {
-                stepperRotation.moveTo(targetSteps);
+                {
+                    StepTimerLock lock;
+                    stepperRotation.moveTo(targetSteps);
+                }
                 Serial.print(F("Moving to absolute position: "));
                 Serial.println(targetSteps);
             }
             else
             {
-                stepperRotation.move(targetSteps);
+                {
+                    StepTimerLock lock;
+                    stepperRotation.move(targetSteps);
+                }
                 Serial.print(F("Moving relative steps: "));
                 Serial.println(targetSteps);
             }
@@ -341,30 +1163,45 @@ bool MovementController::executeCommand(const Command& cmd)
 
 void MovementController::updateSprayControl(const Command& cmd)
 {
+    // Queued X/Y moves switch the relay when their segment starts, so only
+    // direct spray commands act here
     if (cmd.type == 'P')  // Change to 'P' for Paint/spray control
     {
         digitalWrite(PAINT_RELAY_PIN, cmd.sprayOn ? LOW : HIGH);
     }
-    else if (cmd.sprayOn && (cmd.type == 'X' || cmd.type == 'Y' ||
-                             cmd.type == 'M' || cmd.type == 'N'))
-    {
-        digitalWrite(PAINT_RELAY_PIN, LOW);
-    }
 }
 
 bool MovementController::isMoving() const
 {
-    bool moving = const_cast<AccelStepper&>(stepperX).isRunning() ||
-                  const_cast<AccelStepper&>(stepperY).isRunning() ||
-                  const_cast<AccelStepper&>(stepperRotation).isRunning();
-    return moving;
+    return isGantryMoving() || isRotating();
+}
+
+bool MovementController::isGantryMoving() const
+{
+    return interpolator.isActive() || !motionQueue.isEmpty() ||
+           stepperX.isRunning() || stepperY.isRunning();
+}
+
+bool MovementController::isRotating() const
+{
+    return stepperRotation.isRunning();
 }
 
 void MovementController::stop()
 {
-    stepperX.stop();
-    stepperY.stop();
-    stepperRotation.stop();
+    {
+        StepTimerLock lock;
+        motionQueue.clear();
+        interpolator.stop();
+        carrySpeed = 0;
+        exitOpen = false;
+        pausedSegmentPending = false;  // Nothing left to resume
+        resumePending = false;
+        sprayWindowArmed = false;
+        stepperX.stop();
+        stepperY.stop();
+        stepperRotation.stop();
+    }
     // Ensure spray is turned off
     digitalWrite(PAINT_RELAY_PIN, HIGH);
     motorsRunning = false;
@@ -374,14 +1211,17 @@ long MovementController::getCurrentXSteps() const { return lastXPos; }
 
 long MovementController::getCurrentYSteps() const { return lastYPos; }
 
-float MovementController::stepsToInches(long steps, long stepsPerInch) const
-{
-    return static_cast<float>(steps) / stepsPerInch;
-}
-
 void MovementController::stopMovement()
 {
     // Stop all motors
+    StepTimerLock lock;
+    motionQueue.clear();
+    interpolator.stop();
+    carrySpeed = 0;
+    exitOpen = false;
+    pausedSegmentPending = false;  // Nothing left to resume
+    resumePending = false;
+    sprayWindowArmed = false;
     stepperX.stop();
     stepperY.stop();
     stepperRotation.stop();
@@ -401,13 +1241,20 @@ void MovementController::stopMovement()
         }
         continuousMovementActive = false;
     }
-    else if (continuousDiagonalActive)  // Add this block back
+    else if (continuousDiagonalActive)
+    {
+        continuousDiagonalActive = false;
+    }
+    else if (jogActive)
     {
         stepperX.setMaxSpeed(originalXSpeed);
         stepperX.setAcceleration(originalXAccel);
         stepperY.setMaxSpeed(originalYSpeed);
         stepperY.setAcceleration(originalYAccel);
-        continuousDiagonalActive = false;
+        jogRate[0] = 0;
+        jogRate[1] = 0;
+        jogActive = false;
+        jogTicksLeft = 0;
     }
 
     // Ensure spray is turned off
@@ -416,13 +1263,13 @@ void MovementController::stopMovement()
 
 bool MovementController::isManualMovement() const
 {
-    return continuousMovementActive || continuousDiagonalActive;
+    return continuousMovementActive || continuousDiagonalActive || jogActive;
 }
 
 void MovementController::logPosition()
 {
-    float xInches = stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH);
-    float yInches = stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
+    float xInches = XAxis::toUnits(getCurrentXSteps());
+    float yInches = YAxis::toUnits(getCurrentYSteps());
 
     Serial.print(F("Position - X: "));
     Serial.print(xInches);
@@ -433,34 +1280,51 @@ void MovementController::logPosition()
 
 void MovementController::update()
 {
-    // If we're paused, don't update stepper positions
+    // Fall back to polled stepping if the step timer could not be started.
+    // The axes count timer ticks, so run one per tick period that has passed.
+    // This runs while paused too, so a feed hold still brakes to rest.
+    if (!stepTimer.isRunning())
+    {
+        unsigned long period = stepTimer.getPeriodMicros();
+        uint8_t catchUp = 0;
+        while (micros() - lastServiceMicros >= period && catchUp < 50)
+        {
+            serviceSteppers();
+            lastServiceMicros += period;
+            catchUp++;
+        }
+        if (micros() - lastServiceMicros >= period)
+        {
+            lastServiceMicros = micros();  // Too far behind, drop the rest
+        }
+    }
+
+    // A resume asked for during the hold waits until the head is at rest
+    if (executionPaused && resumePending && isHoldSettled())
+    {
+        finishResume();
+    }
+
+    updateSprayDuty();
+
+    // If we're paused, skip the position tracking below
     if (executionPaused)
     {
         return;
     }
 
-    // Update motor states
-    stepperX.run();
-    stepperY.run();
-    stepperRotation.run();
-
     // Update motorsRunning flag based on actual motor states
-    motorsRunning = stepperX.isRunning() || stepperY.isRunning() ||
-                    stepperRotation.isRunning();
+    motorsRunning = isMoving();
 
     // Update position cache
     updatePositionCache();
 
     // Check for limit clears during any movement
-    float currentXInches = stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH);
-    float currentYInches = stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
-
     static bool xWasAtLimit = false;
     static bool yWasAtLimit = false;
 
     // Check X axis limit clear
-    bool xAtLimit = (currentXInches <= MIN_TRAVEL_INCHES ||
-                     currentXInches >= MAX_X_TRAVEL_INCHES);
+    bool xAtLimit = XAxis::atLimit(getCurrentXSteps());
     if (xWasAtLimit && !xAtLimit)
     {
         Serial.println(F("LIMIT_CLEAR:X"));
@@ -468,8 +1332,7 @@ void MovementController::update()
     xWasAtLimit = xAtLimit;
 
     // Check Y axis limit clear
-    bool yAtLimit = (currentYInches <= MIN_TRAVEL_INCHES ||
-                     currentYInches >= MAX_Y_TRAVEL_INCHES);
+    bool yAtLimit = YAxis::atLimit(getCurrentYSteps());
     if (yWasAtLimit && !yAtLimit)
     {
         Serial.println(F("LIMIT_CLEAR:Y"));
@@ -478,8 +1341,7 @@ void MovementController::update()
 
     // Update motors running status
     bool previouslyRunning = motorsRunning;
-    motorsRunning = stepperX.isRunning() || stepperY.isRunning() ||
-                    stepperRotation.isRunning();
+    motorsRunning = isMoving();
 
     // Log position during any movement (manual or pattern)
     if (motorsRunning)
@@ -545,7 +1407,7 @@ void MovementController::update()
     // Handle continuous movement
     if (continuousMovementActive)
     {
-        AccelStepper& stepper = continuousMovementIsX ? stepperX : stepperY;
+        StepperAxis& stepper = continuousMovementIsX ? stepperX : stepperY;
         if (!stepper.isRunning())
         {
             // Movement complete - restore original values
@@ -557,6 +1419,7 @@ void MovementController::update()
                 Serial.print(F("Restoring to: "));
                 Serial.println(originalXSpeed);
 
+                StepTimerLock lock;
                 stepperX.setMaxSpeed(originalXSpeed);
                 stepperX.setAcceleration(originalXAccel);
             }
@@ -568,6 +1431,7 @@ void MovementController::update()
                 Serial.print(F("Restoring to: "));
                 Serial.println(originalYSpeed);
 
+                StepTimerLock lock;
                 stepperY.setMaxSpeed(originalYSpeed);
                 stepperY.setAcceleration(originalYAccel);
             }
@@ -579,16 +1443,14 @@ void MovementController::update()
             return;
         }
         // Check if we've hit the limit
-        float currentInches =
+        long currentSteps =
+            continuousMovementIsX ? getCurrentXSteps() : getCurrentYSteps();
+        bool atLimit =
             continuousMovementIsX
-                ? stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH)
-                : stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
-
-        float maxTravel =
-            continuousMovementIsX ? MAX_X_TRAVEL_INCHES : MAX_Y_TRAVEL_INCHES;
+                ? XAxis::atLimit(currentSteps, continuousMovementPositive)
+                : YAxis::atLimit(currentSteps, continuousMovementPositive);
 
-        // Add minimum travel check
-        if (continuousMovementPositive && currentInches >= maxTravel)
+        if (atLimit && continuousMovementPositive)
         {
             // Log limit reached before position
             Serial.println(continuousMovementIsX ? F("LIMIT:X_MAX")
@@ -599,8 +1461,7 @@ void MovementController::update()
             continuousMovementActive = false;
             return;
         }
-        else if (!continuousMovementPositive &&
-                 currentInches <= MIN_TRAVEL_INCHES)
+        else if (atLimit)
         {
             // Log limit reached before position
             Serial.println(continuousMovementIsX ? F("LIMIT:X_MIN")
@@ -611,131 +1472,164 @@ void MovementController::update()
             continuousMovementActive = false;
             return;
         }
-
-        // Calculate target that respects both min and max limits
-        float targetInches =
-            continuousMovementPositive ? maxTravel : MIN_TRAVEL_INCHES;
-        long stepsPerInch =
-            continuousMovementIsX ? X_STEPS_PER_INCH : Y_STEPS_PER_INCH;
-        long targetSteps = targetInches * stepsPerInch;
-
-        stepper.moveTo(targetSteps);
     }
 
-    // Handle continuous diagonal movement
-    if (continuousDiagonalActive)
+    if (jogActive)
     {
-        if (!stepperX.isRunning() && !stepperY.isRunning())
-        {
-            // Movement complete - restore original values
-            stepperX.setMaxSpeed(originalXSpeed);
-            stepperX.setAcceleration(originalXAccel);
-            stepperY.setMaxSpeed(originalYSpeed);
-            stepperY.setAcceleration(originalYAccel);
-            continuousDiagonalActive = false;
-            return;
-        }
-        // Check if we've hit any limits
-        float currentXInches =
-            stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH);
-        float currentYInches =
-            stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
-
-        static bool xLimitReported = false;
-        static bool yLimitReported = false;
-
-        // Clear limit flags if we've moved away from limits
-        if (currentXInches > MIN_TRAVEL_INCHES &&
-            currentXInches < MAX_X_TRAVEL_INCHES)
-        {
-            if (xLimitReported)
-            {
-                Serial.println(F("LIMIT_CLEAR:X"));
-                xLimitReported = false;
-            }
-        }
-        if (currentYInches > MIN_TRAVEL_INCHES &&
-            currentYInches < MAX_Y_TRAVEL_INCHES)
-        {
-            if (yLimitReported)
-            {
-                Serial.println(F("LIMIT_CLEAR:Y"));
-                yLimitReported = false;
-            }
-        }
-
-        bool xAtLimit = (continuousDiagonalXPositive &&
-                         currentXInches >= MAX_X_TRAVEL_INCHES) ||
-                        (!continuousDiagonalXPositive &&
-                         currentXInches <= MIN_TRAVEL_INCHES);
-        bool yAtLimit = (continuousDiagonalYPositive &&
-                         currentYInches >= MAX_Y_TRAVEL_INCHES) ||
-                        (!continuousDiagonalYPositive &&
-                         currentYInches <= MIN_TRAVEL_INCHES);
-
-        // Log limits as they are reached (only once)
-        if (xAtLimit && !xLimitReported)
-        {
-            Serial.println(continuousDiagonalXPositive ? F("LIMIT:X_MAX")
-                                                       : F("LIMIT:X_MIN"));
-            xLimitReported = true;
-        }
-        if (yAtLimit && !yLimitReported)
-        {
-            Serial.println(continuousDiagonalYPositive ? F("LIMIT:Y_MAX")
-                                                       : F("LIMIT:Y_MIN"));
-            yLimitReported = true;
-        }
-
-        // Only stop movement when both axes have reached their limits or
-        // intended targets
-        if ((xAtLimit || !stepperX.isRunning()) &&
-            (yAtLimit || !stepperY.isRunning()))
-        {
-            Serial.println(
-                F("Diagonal movement reached limit. Final position:"));
-            logPosition();
-            continuousDiagonalActive = false;
-            // Reset limit reported flags when movement completes
-            xLimitReported = false;
-            yLimitReported = false;
-            return;
-        }
+        updateJog();
+    }
 
-        // Set new targets if needed
-        if (!xAtLimit && !stepperX.isRunning())
-        {
-            float targetX = continuousDiagonalXPositive ? MAX_X_TRAVEL_INCHES
-                                                        : MIN_TRAVEL_INCHES;
-            stepperX.moveTo(targetX * X_STEPS_PER_INCH);
-        }
-        if (!yAtLimit && !stepperY.isRunning())
-        {
-            float targetY = continuousDiagonalYPositive ? MAX_Y_TRAVEL_INCHES
-                                                        : MIN_TRAVEL_INCHES;
-            stepperY.moveTo(targetY * Y_STEPS_PER_INCH);
-        }
+    // Handle continuous diagonal movement. The interpolated line ends on
+    // both travel limits at once, so it is finished when the move is.
+    if (continuousDiagonalActive && !interpolator.isActive())
+    {
+        Serial.println(continuousDiagonalXPositive ? F("LIMIT:X_MAX")
+                                                   : F("LIMIT:X_MIN"));
+        Serial.println(continuousDiagonalYPositive ? F("LIMIT:Y_MAX")
+                                                   : F("LIMIT:Y_MIN"));
+        Serial.println(F("Diagonal movement reached limit. Final position:"));
+        logPosition();
+        continuousDiagonalActive = false;
     }
 }
 
 void MovementController::setXPosition(long position)
 {
-    stepperX.setCurrentPosition(position);
+    {
+        // Re-zeroing halts the axis outright
+        StepTimerLock lock;
+        motionQueue.clear();
+        interpolator.abort();
+        carrySpeed = 0;
+        exitOpen = false;
+        stepperX.setCurrentPosition(position);
+    }
     updatePositionCache();
+    syncPlannedPosition();
 }
 
 void MovementController::setYPosition(long position)
 {
-    stepperY.setCurrentPosition(position);
+    {
+        // Re-zeroing halts the axis outright
+        StepTimerLock lock;
+        motionQueue.clear();
+        interpolator.abort();
+        carrySpeed = 0;
+        exitOpen = false;
+        stepperY.setCurrentPosition(position);
+    }
     updatePositionCache();
+    syncPlannedPosition();
 }
 
-void MovementController::setXSpeed(float speed) { stepperX.setMaxSpeed(speed); }
+void MovementController::setXSpeed(float speed)
+{
+    StepTimerLock lock;
+    stepperX.setMaxSpeed(speed);
+}
 
-void MovementController::setYSpeed(float speed) { stepperY.setMaxSpeed(speed); }
+void MovementController::setYSpeed(float speed)
+{
+    StepTimerLock lock;
+    stepperY.setMaxSpeed(speed);
+}
 
 float MovementController::getCurrentXSpeed() { return stepperX.maxSpeed(); }
 
+float MovementController::estimateMoveSeconds(bool isXAxis, long steps,
+                                              bool sprayOn,
+                                              const String& pattern) const
+{
+    if (!sprayOn)
+    {
+        return estimateRapidSeconds(isXAxis, steps);
+    }
+    float speed = isXAxis ? patternSpeed(pattern) : stepperY.maxSpeed();
+    float accel = isXAxis ? stepperX.acceleration() : stepperY.acceleration();
+    return estimateAtSpeed(isXAxis, steps, speed, accel);
+}
+
+float MovementController::estimateRapidSeconds(bool isXAxis, long steps) const
+{
+    return estimateAtSpeed(isXAxis, steps, isXAxis ? xRapidSpeed : yRapidSpeed,
+                           isXAxis ? xRapidAccel : yRapidAccel);
+}
+
+float MovementController::estimateAtSpeed(bool isXAxis, long steps,
+                                          float speed, float accel) const
+{
+    float axisSpeed = isXAxis ? X_SPEED : Y_SPEED;
+    float ceiling = max(speed, axisSpeed);
+    return rampedMoveSeconds(labs(steps), min(speed * feedOverride, ceiling),
+                             accel, isXAxis ? xJerk : yJerk);
+}
+
+float MovementController::estimateRotationSeconds(long steps) const
+{
+    return rampedMoveSeconds(labs(steps), stepperRotation.maxSpeed(),
+                             stepperRotation.acceleration(), 0);
+}
+
+float MovementController::estimateQueuedSeconds() const
+{
+    // Copy out what the estimate needs, keeping the interrupt held off for
+    // as short a time as possible
+    struct Planned
+    {
+        float length;
+        float speed;
+        float accel;
+        float jerk;
+    } segments[MotionQueue::CAPACITY];
+    uint8_t count = 0;
+    Planned running = {0, 0, 0, 0};
+    {
+        StepTimerLock lock;
+        if (segmentRunning)
+        {
+            int major = fabsf(activeSegment.unit[0]) >=
+                                fabsf(activeSegment.unit[1])
+                            ? 0
+                            : 1;
+            long at = major == 0 ? stepperX.currentPosition()
+                                 : stepperY.currentPosition();
+            running.length = labs(activeSegment.target[major] - at) *
+                             activeSegment.inchesPerStep;
+            running.speed =
+                activeSegment.nominalSpeed * overrideScale(activeSegment);
+            running.accel = activeSegment.pathAccel;
+        }
+        for (; count < motionQueue.size(); count++)
+        {
+            const MotionSegment& queued = motionQueue.at(count);
+            segments[count].length = queued.length;
+            segments[count].speed =
+                queued.nominalSpeed * overrideScale(queued);
+            segments[count].accel = queued.pathAccel;
+            segments[count].jerk = queued.pathJerk;
+        }
+    }
+
+    // The running segment is taken to be at speed, with only the braking at
+    // its end left
+    float seconds = 0;
+    if (running.length > 0 && running.speed > 0 && running.accel > 0)
+    {
+        float braking = running.speed * running.speed / (2.0f * running.accel);
+        seconds = running.length >= braking
+                      ? running.length / running.speed + braking / running.speed
+                      : sqrtf(2.0f * running.length / running.accel);
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        seconds += rampedMoveSeconds(segments[i].length, segments[i].speed,
+                                     segments[i].accel, segments[i].jerk);
+    }
+    return seconds;
+}
+
 bool MovementController::startContinuousMovement(bool isXAxis, bool isPositive,
                                                  float speed,
                                                  float acceleration)
@@ -762,43 +1656,42 @@ bool MovementController::startContinuousMovement(bool isXAxis, bool isPositive,
     Serial.println(speed);
 
     // Get current position in inches
-    float currentInches =
-        isXAxis ? stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH)
-                : stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
+    long currentSteps = isXAxis ? getCurrentXSteps() : getCurrentYSteps();
+    float currentInches = isXAxis ? XAxis::toUnits(currentSteps)
+                                  : YAxis::toUnits(currentSteps);
 
     Serial.println(F("=== Starting Continuous Movement ==="));
     Serial.print(F("Current position (inches): "));
     Serial.println(currentInches);
 
     // Check if we're already at the limit in the requested direction
-    float maxTravel = isXAxis ? MAX_X_TRAVEL_INCHES : MAX_Y_TRAVEL_INCHES;
-
-    if ((isPositive && currentInches >= maxTravel) ||
-        (!isPositive &&
-         currentInches <= MIN_TRAVEL_INCHES))  // Changed from <= -maxTravel
+    if (isXAxis ? XAxis::atLimit(currentSteps, isPositive)
+                : YAxis::atLimit(currentSteps, isPositive))
     {
         Serial.println(F("Already at travel limit, movement blocked"));
         return false;
     }
 
     // Set movement parameters
-    AccelStepper& stepper = isXAxis ? stepperX : stepperY;
-    stepper.setMaxSpeed(speed);
-    stepper.setAcceleration(acceleration);
-
-    // Calculate target that won't exceed limits
-    long stepsPerInch = isXAxis ? X_STEPS_PER_INCH : Y_STEPS_PER_INCH;
-    long currentSteps = isXAxis ? getCurrentXSteps() : getCurrentYSteps();
+    StepperAxis& stepper = isXAxis ? stepperX : stepperY;
+    {
+        StepTimerLock lock;
+        stepper.setMaxSpeed(speed);
+        stepper.setAcceleration(acceleration);
+    }
 
     // Set target to the appropriate limit in the requested direction
-    float targetInches =
-        isPositive ? maxTravel : MIN_TRAVEL_INCHES;  // Changed from -maxTravel
-    long targetSteps = targetInches * stepsPerInch;
+    long targetSteps = isXAxis ? XAxis::limitSteps(isPositive)
+                               : YAxis::limitSteps(isPositive);
 
     Serial.print(F("Setting target to (inches): "));
-    Serial.println(targetInches);
+    Serial.println(isXAxis ? XAxis::toUnits(targetSteps)
+                           : YAxis::toUnits(targetSteps));
 
-    stepper.moveTo(targetSteps);
+    {
+        StepTimerLock lock;
+        stepper.moveTo(targetSteps);
+    }
 
     // Update tracking variables
     continuousMovementActive = true;
@@ -808,6 +1701,120 @@ bool MovementController::startContinuousMovement(bool isXAxis, bool isPositive,
     return true;
 }
 
+bool MovementController::jog(float xFraction, float yFraction)
+{
+    if (!jogActive)
+    {
+        if (xFraction == 0 && yFraction == 0)
+        {
+            return true;  // Nothing to start
+        }
+        if (isMoving())
+        {
+            Serial.println(F("Jog blocked, axes are busy"));
+            return false;
+        }
+
+        originalXSpeed = stepperX.maxSpeed();
+        originalXAccel = stepperX.acceleration();
+        originalYSpeed = stepperY.maxSpeed();
+        originalYAccel = stepperY.acceleration();
+        {
+            StepTimerLock lock;
+            stepperX.setAcceleration(X_ACCEL);
+            stepperY.setAcceleration(Y_ACCEL);
+        }
+        jogActive = true;
+    }
+
+    // A packet after the step interrupt braked starts the axes again
+    if (jogTimedOut)
+    {
+        jogTimeout();
+    }
+    jogHeartbeat();
+    setJogRate(0, constrain(xFraction, -1.0f, 1.0f) * X_SPEED);
+    setJogRate(1, constrain(yFraction, -1.0f, 1.0f) * Y_SPEED);
+    return true;
+}
+
+void MovementController::setJogRate(int axis, float rate)
+{
+    // Nothing to do at a limit in the direction asked for
+    long position = axis == 0 ? getCurrentXSteps() : getCurrentYSteps();
+    bool atLimit = axis == 0 ? XAxis::atLimit(position, rate > 0)
+                             : YAxis::atLimit(position, rate > 0);
+    if (atLimit)
+    {
+        rate = 0;
+    }
+
+    // Repeated packets leave the ramp alone
+    if (rate == jogRate[axis])
+    {
+        return;
+    }
+    jogRate[axis] = rate;
+
+    StepperAxis& stepper = axis == 0 ? stepperX : stepperY;
+    StepTimerLock lock;
+    if (rate == 0)
+    {
+        stepper.stop();
+        return;
+    }
+
+    // Run towards the travel limit; a lower speed or the other direction
+    // is reached by the axis' own ramp
+    stepper.setMaxSpeed(fabsf(rate));
+    stepper.moveTo(axis == 0 ? XAxis::limitSteps(rate > 0)
+                             : YAxis::limitSteps(rate > 0));
+}
+
+void MovementController::jogHeartbeat()
+{
+    lastJogPacket = millis();
+    if (jogActive)
+    {
+        jogTicksLeft =
+            JOG_HEARTBEAT_TIMEOUT_MS * STEP_TIMER_FREQUENCY_HZ / 1000;
+    }
+}
+
+void MovementController::jogTimeout()
+{
+    jogTimedOut = false;
+    if (jogRate[0] != 0 || jogRate[1] != 0)
+    {
+        Serial.println(F("JOG:TIMEOUT"));
+        setJogRate(0, 0);
+        setJogRate(1, 0);
+    }
+}
+
+void MovementController::updateJog()
+{
+    // Deadman: the pendant has gone quiet, so brake to a stop. The step
+    // interrupt has normally started braking already.
+    if (jogTimedOut || millis() - lastJogPacket > JOG_HEARTBEAT_TIMEOUT_MS)
+    {
+        jogTimeout();
+    }
+
+    // The jog is over once both axes are asked to stop and have
+    if (jogRate[0] == 0 && jogRate[1] == 0 && !stepperX.isRunning() &&
+        !stepperY.isRunning())
+    {
+        StepTimerLock lock;
+        stepperX.setMaxSpeed(originalXSpeed);
+        stepperX.setAcceleration(originalXAccel);
+        stepperY.setMaxSpeed(originalYSpeed);
+        stepperY.setAcceleration(originalYAccel);
+        jogActive = false;
+        jogTicksLeft = 0;
+    }
+}
+
 bool MovementController::startContinuousDiagonalMovement(bool xPositive,
                                                          bool yPositive,
                                                          float speed,
@@ -815,16 +1822,17 @@ bool MovementController::startContinuousDiagonalMovement(bool xPositive,
 {
     // Stop any existing movement first
     stopMovement();
-
-    // Store original values using defaults
-    originalXSpeed = X_SPEED;
-    originalYSpeed = Y_SPEED;
-    originalXAccel = X_ACCEL;
-    originalYAccel = Y_ACCEL;
+    if (interpolator.isActive())
+    {
+        Serial.println(F("Previous movement still stopping, movement blocked"));
+        return false;
+    }
 
     // Get current positions
-    float currentXInches = stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH);
-    float currentYInches = stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
+    long currentXSteps = getCurrentXSteps();
+    long currentYSteps = getCurrentYSteps();
+    float currentXInches = XAxis::toUnits(currentXSteps);
+    float currentYInches = YAxis::toUnits(currentYSteps);
 
     Serial.println(F("=== Starting Continuous Diagonal Movement ==="));
     Serial.print(F("Current X (inches): "));
@@ -833,52 +1841,30 @@ bool MovementController::startContinuousDiagonalMovement(bool xPositive,
     Serial.println(currentYInches);
 
     // Check if either axis is already at its limit
-    if ((xPositive && currentXInches >= MAX_X_TRAVEL_INCHES) ||
-        (!xPositive && currentXInches <= MIN_TRAVEL_INCHES) ||
-        (yPositive && currentYInches >= MAX_Y_TRAVEL_INCHES) ||
-        (!yPositive && currentYInches <= MIN_TRAVEL_INCHES))
+    if (XAxis::atLimit(currentXSteps, xPositive) ||
+        YAxis::atLimit(currentYSteps, yPositive))
     {
         Serial.println(F("Already at travel limit, movement blocked"));
         return false;
     }
 
-    // Calculate the remaining travel distance for each axis
-    float remainingX = xPositive ? (MAX_X_TRAVEL_INCHES - currentXInches)
-                                 : (currentXInches - MIN_TRAVEL_INCHES);
-    float remainingY = yPositive ? (MAX_Y_TRAVEL_INCHES - currentYInches)
-                                 : (currentYInches - MIN_TRAVEL_INCHES);
-
-    // Calculate speed ratios to maintain true diagonal movement
-    float totalStepsX = remainingX * X_STEPS_PER_INCH;
-    float totalStepsY = remainingY * Y_STEPS_PER_INCH;
-
-    // Adjust speeds proportionally based on the number of steps each motor
-    // needs to move
-    float speedRatio = totalStepsX / totalStepsY;
-    float xSpeed = speedRatio >= 1.0 ? speed : speed * speedRatio;
-    float ySpeed = speedRatio >= 1.0 ? speed / speedRatio : speed;
-
-    // Set movement parameters for both axes
-    stepperX.setMaxSpeed(xSpeed);
-    stepperY.setMaxSpeed(ySpeed);
-    stepperX.setAcceleration(acceleration);
-    stepperY.setAcceleration(acceleration);
-
     // Set targets to appropriate limits
-    float targetX = xPositive ? MAX_X_TRAVEL_INCHES : MIN_TRAVEL_INCHES;
-    float targetY = yPositive ? MAX_Y_TRAVEL_INCHES : MIN_TRAVEL_INCHES;
+    long targetX = XAxis::limitSteps(xPositive);
+    long targetY = YAxis::limitSteps(yPositive);
 
     Serial.print(F("Target X (inches): "));
-    Serial.println(targetX);
+    Serial.println(XAxis::toUnits(targetX));
     Serial.print(F("Target Y (inches): "));
-    Serial.println(targetY);
-    Serial.print(F("X Speed: "));
-    Serial.println(xSpeed);
-    Serial.print(F("Y Speed: "));
-    Serial.println(ySpeed);
+    Serial.println(YAxis::toUnits(targetY));
 
-    stepperX.moveTo(targetX * X_STEPS_PER_INCH);
-    stepperY.moveTo(targetY * Y_STEPS_PER_INCH);
+    // Speed and acceleration apply to whichever axis travels furthest; the
+    // other axis is interpolated along the same line
+    if (!startInterpolatedMove(targetX, targetY, speed, speed, acceleration,
+                               acceleration))
+    {
+        Serial.println(F("Failed to plan diagonal movement"));
+        return false;
+    }
 
     // Update tracking variables
     continuousDiagonalActive = true;
@@ -889,90 +1875,89 @@ bool MovementController::startContinuousDiagonalMovement(bool xPositive,
     return true;
 }
 
-void MovementController::toggleSpray(bool on)
+bool MovementController::moveToPosition(float xInches, float yInches)
 {
-    digitalWrite(PAINT_RELAY_PIN, on ? LOW : HIGH);
+    syncPlannedPosition();
+    long xMicros = inchesToMicros(xInches);
+    long yMicros = inchesToMicros(yInches);
+    enforceLimit<XAxis>(xMicros, plannedXMicros, xHomed);
+    enforceLimit<YAxis>(yMicros, plannedYMicros, yHomed);
+    long xTarget = XAxis::microsToSteps(xMicros);
+    long yTarget = YAxis::microsToSteps(yMicros);
+
+    if (!startInterpolatedMove(xTarget, yTarget, stepperX.maxSpeed(),
+                               stepperY.maxSpeed(), stepperX.acceleration(),
+                               stepperY.acceleration()))
+    {
+        return false;
+    }
+
+    // Later relative moves continue from the exact position asked for
+    plannedXMicros = xMicros;
+    plannedYMicros = yMicros;
+    plannedXSteps = xTarget;
+    plannedYSteps = yTarget;
+    return true;
 }
 
-// Add these helper methods to enforce limits while allowing movement up to them
-void MovementController::enforceXLimit(long& targetSteps)
+bool MovementController::startInterpolatedMove(long xTarget, long yTarget,
+                                               float xRate, float yRate,
+                                               float xAccel, float yAccel)
 {
-    // During homing or if not yet homed, don't enforce lower limit
-    if (!xHomed ||
-        (stateManager && (stateManager->getCurrentState() == HOMING_X ||
-                          stateManager->getCurrentState() == HOMING_Y ||
-                          stateManager->getCurrentState() == HOMING_ROTATION)))
-    {
-        // Only enforce upper limit
-        float currentInches =
-            stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH);
-        float targetInches = stepsToInches(targetSteps, X_STEPS_PER_INCH);
-        float relativeMovement = targetInches - currentInches;
-
-        if (relativeMovement > MAX_X_TRAVEL_INCHES)
-        {
-            float clampedRelative = MAX_X_TRAVEL_INCHES;
-            targetSteps =
-                getCurrentXSteps() + (clampedRelative * X_STEPS_PER_INCH);
-        }
-        return;
-    }
+    long targets[2] = {xTarget, yTarget};
+    float rates[2] = {xRate, yRate};
+    float accels[2] = {xAccel, yAccel};
+    float jerks[2] = {xJerk, yJerk};
 
-    // Normal operation with both limits
-    float currentInches = stepsToInches(getCurrentXSteps(), X_STEPS_PER_INCH);
-    float targetInches = stepsToInches(targetSteps, X_STEPS_PER_INCH);
-    float relativeMovement = targetInches - currentInches;
+    StepTimerLock lock;
 
-    if (relativeMovement <
-        (MIN_TRAVEL_INCHES - currentInches))  // Would move below minimum
+    // X and Y must be idle, with nothing left in the segment queue
+    if (interpolator.isActive() || !motionQueue.isEmpty() ||
+        stepperX.isRunning() || stepperY.isRunning())
     {
-        targetSteps = MIN_TRAVEL_INCHES * X_STEPS_PER_INCH;  // Clamp at minimum
+        return false;
     }
-    else if (relativeMovement >
-             (MAX_X_TRAVEL_INCHES - currentInches))  // Would exceed max
+
+    interpolator.setRateScale(1.0f);  // Direct moves ignore the override
+    if (!interpolator.begin(targets, rates, accels, jerks))
     {
-        targetSteps = MAX_X_TRAVEL_INCHES * X_STEPS_PER_INCH;
+        return false;
     }
+    motorsRunning = interpolator.isActive();
+    return true;
+}
+
+void MovementController::toggleSpray(bool on)
+{
+    digitalWrite(PAINT_RELAY_PIN, on ? LOW : HIGH);
+}
+
+// Add these helper methods to enforce limits while allowing movement up to them
+bool MovementController::isHoming() const
+{
+    return stateManager && (stateManager->getCurrentState() == HOMING_X ||
+                            stateManager->getCurrentState() == HOMING_Y ||
+                            stateManager->getCurrentState() == HOMING_ROTATION);
 }
 
-void MovementController::enforceYLimit(long& targetSteps)
+template <typename AxisLimits>
+void MovementController::enforceLimit(long& targetMicros, long plannedMicros,
+                                      bool homed) const
 {
     // During homing or if not yet homed, don't enforce lower limit
-    if (!yHomed ||
-        (stateManager && (stateManager->getCurrentState() == HOMING_X ||
-                          stateManager->getCurrentState() == HOMING_Y ||
-                          stateManager->getCurrentState() == HOMING_ROTATION)))
+    if (!homed || isHoming())
     {
         // Only enforce upper limit
-        float currentInches =
-            stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
-        float targetInches = stepsToInches(targetSteps, Y_STEPS_PER_INCH);
-        float relativeMovement = targetInches - currentInches;
-
-        if (relativeMovement > MAX_Y_TRAVEL_INCHES)
+        long relativeMovement = targetMicros - plannedMicros;
+        if (relativeMovement > AxisLimits::MAX_MICROS)
         {
-            float clampedRelative = MAX_Y_TRAVEL_INCHES;
-            targetSteps =
-                getCurrentYSteps() + (clampedRelative * Y_STEPS_PER_INCH);
+            targetMicros = plannedMicros + AxisLimits::MAX_MICROS;
         }
         return;
     }
 
     // Normal operation with both limits
-    float currentInches = stepsToInches(getCurrentYSteps(), Y_STEPS_PER_INCH);
-    float targetInches = stepsToInches(targetSteps, Y_STEPS_PER_INCH);
-    float relativeMovement = targetInches - currentInches;
-
-    if (relativeMovement <
-        (MIN_TRAVEL_INCHES - currentInches))  // Would move below minimum
-    {
-        targetSteps = MIN_TRAVEL_INCHES * Y_STEPS_PER_INCH;  // Clamp at minimum
-    }
-    else if (relativeMovement >
-             (MAX_Y_TRAVEL_INCHES - currentInches))  // Would exceed max
-    {
-        targetSteps = MAX_Y_TRAVEL_INCHES * Y_STEPS_PER_INCH;
-    }
+    targetMicros = AxisLimits::clampMicros(targetMicros);
 }
 
 bool MovementController::isPositionValid(long xSteps, long ySteps) const
@@ -988,56 +1973,88 @@ bool MovementController::isPositionValid(long xSteps, long ySteps) const
 
 void MovementController::pauseExecution()
 {
-    if (!executionPaused && stateManager)
+    if (executionPaused && resumePending && stateManager)
     {
-        // Store current positions and speeds
-        pausedXPosition = stepperX.currentPosition();
-        pausedYPosition = stepperY.currentPosition();
-        pausedRotationPosition = stepperRotation.currentPosition();
-
-        pausedXSpeed = stepperX.maxSpeed();
-        pausedYSpeed = stepperY.maxSpeed();
-        pausedRotationSpeed = stepperRotation.maxSpeed();
+        // Paused again before the last hold had even settled
+        resumePending = false;
+        stateManager->setState(PAUSED);
+        return;
+    }
 
-        // Stop all motors immediately
-        stepperX.stop();
-        stepperY.stop();
-        stepperRotation.stop();
+    if (!executionPaused && stateManager)
+    {
+        {
+            StepTimerLock lock;
+
+            // Store where rotation was headed and the current speeds
+            pausedRotationTarget = stepperRotation.targetPosition();
+            pausedXSpeed = stepperX.maxSpeed();
+            pausedYSpeed = stepperY.maxSpeed();
+            pausedRotationSpeed = stepperRotation.maxSpeed();
+
+            // Brake along the current path and hold the segment queue. The
+            // step interrupt carries on decelerating; nothing waits here.
+            executionPaused = true;
+            resumePending = false;
+            pausedSegmentPending = segmentRunning;
+            sprayWindowArmed = false;
+            interpolator.stop();
+            carrySpeed = 0;
+            exitOpen = false;
+            stepperX.stop();
+            stepperY.stop();
+            stepperRotation.stop();
+        }
 
         // Turn off spray
         digitalWrite(PAINT_RELAY_PIN, HIGH);
 
         // Set the paused state
-        executionPaused = true;
         stateManager->setState(PAUSED);
+    }
+}
 
-        // Wait for motors to come to a complete stop
-        while (stepperX.isRunning() || stepperY.isRunning() ||
-               stepperRotation.isRunning())
-        {
-            stepperX.run();
-            stepperY.run();
-            stepperRotation.run();
-        }
+bool MovementController::isHoldSettled() const
+{
+    return !interpolator.isActive() && !stepperX.isRunning() &&
+           !stepperY.isRunning() && !stepperRotation.isRunning();
+}
+
+void MovementController::finishResume()
+{
+    StepTimerLock lock;
+
+    // Restore speeds
+    stepperX.setMaxSpeed(pausedXSpeed);
+    stepperY.setMaxSpeed(pausedYSpeed);
+    stepperRotation.setMaxSpeed(pausedRotationSpeed);
+
+    // Carry on to wherever rotation was headed
+    stepperRotation.moveTo(pausedRotationTarget);
+
+    // Segments hold absolute targets, so the interrupted one continues from
+    // wherever the head came to rest, with the valve reopened as it starts
+    if (pausedSegmentPending)
+    {
+        startSpray();
+        beginActiveSegment(0);
+        pausedSegmentPending = false;
     }
+
+    // Reset pause state
+    resumePending = false;
+    executionPaused = false;
 }
 
 void MovementController::resumeExecution()
 {
     if (executionPaused && stateManager)
     {
-        // Restore speeds
-        stepperX.setMaxSpeed(pausedXSpeed);
-        stepperY.setMaxSpeed(pausedYSpeed);
-        stepperRotation.setMaxSpeed(pausedRotationSpeed);
-
-        // Move back to the positions where we paused
-        stepperX.moveTo(pausedXPosition);
-        stepperY.moveTo(pausedYPosition);
-        stepperRotation.moveTo(pausedRotationPosition);
-
-        // Reset pause state
-        executionPaused = false;
+        resumePending = true;
+        if (isHoldSettled())
+        {
+            finishResume();
+        }
 
         // Restore previous state (either EXECUTING_PATTERN or PAINTING_SIDE)
         SystemState previousState = stateManager->getPreviousState();
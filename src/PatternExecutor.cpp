@@ -3,7 +3,127 @@
 #include <Arduino.h>
 #include <config.h>
 
+#include "Axis.h"
 #include "Patterns.h"
+#include "Units.h"
+
+namespace
+{
+// Axis whose micro-inch target lies outside its travel, or 0 if none
+char axisOutsideLimits(long xMicros, long yMicros)
+{
+    if (xMicros < XAxis::MIN_MICROS || xMicros > XAxis::MAX_MICROS)
+    {
+        return 'X';
+    }
+    if (yMicros < YAxis::MIN_MICROS || yMicros > YAxis::MAX_MICROS)
+    {
+        return 'Y';
+    }
+    return 0;
+}
+
+// Moves the micro-inch position by a command, returning the axis it moved
+// (0 X, 1 Y) or -1 if it is not a move
+int applyMove(const Command& cmd, long pos[2])
+{
+    switch (cmd.type)
+    {
+        case 'X':
+            pos[0] += inchesToMicros(cmd.value);
+            return 0;
+        case 'Y':
+            pos[1] += inchesToMicros(cmd.value);
+            return 1;
+        case 'M':
+            pos[0] = inchesToMicros(cmd.value);
+            return 0;
+        case 'N':
+            pos[1] = inchesToMicros(cmd.value);
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+const char* sideName(int side)
+{
+    switch (side)
+    {
+        case 0:
+            return "FRONT";
+        case 1:
+            return "BACK";
+        case 2:
+            return "LEFT";
+        case 3:
+            return "RIGHT";
+        case 4:
+            return "LIP";
+        default:
+            return "";
+    }
+}
+
+// Table angle each side is painted at, in degrees from the front. The lip
+// is painted at 90 degrees after the other sides, and from the front when
+// painted on its own.
+int sideRotation(int side, bool singleSide)
+{
+    switch (side)
+    {
+        case 1:  // BACK
+            return 180;
+        case 2:  // LEFT
+            return 90;
+        case 3:  // RIGHT
+            return 270;
+        case 4:  // LIP
+            return singleSide ? 0 : 90;
+        default:  // FRONT
+            return 0;
+    }
+}
+
+// Steps values[] on to its next ordering, lexicographically; false once
+// they are in the last
+bool nextPermutation(int values[], int count)
+{
+    int i = count - 2;
+    while (i >= 0 && values[i] >= values[i + 1])
+    {
+        i--;
+    }
+    if (i < 0)
+    {
+        return false;
+    }
+    int j = count - 1;
+    while (values[j] <= values[i])
+    {
+        j--;
+    }
+    int swapped = values[i];
+    values[i] = values[j];
+    values[j] = swapped;
+    for (int low = i + 1, high = count - 1; low < high; low++, high--)
+    {
+        swapped = values[low];
+        values[low] = values[high];
+        values[high] = swapped;
+    }
+    return true;
+}
+
+// The same as a table index in steps
+long sideIndex(int side, bool singleSide)
+{
+    return roundedDivide(
+        static_cast<int64_t>(sideRotation(side, singleSide)) *
+            STEPS_PER_ROTATION,
+        360);
+}
+}  // namespace
 
 // Structured status reporting
 void PatternExecutor::reportStatus(const char* event, const String& details)
@@ -15,42 +135,45 @@ void PatternExecutor::reportStatus(const char* event, const String& details)
     status += "command=" + String(currentCommand) + "|";
     status += "total_commands=" + String(getCurrentPatternSize()) + "|";
     status += "single_side=" + String(executingSingleSide ? "true" : "false");
+    status += "|queue_depth=" + String(movementController.getQueueDepth());
+    status += "|eta_ms=" + String(lroundf(estimateRemainingSeconds() * 1000));
 
     // Add movement-specific information for MOVE_X and MOVE_Y events
-    Command* pattern = getCurrentPattern();
-    if (pattern != nullptr && currentCommand >= 0 &&
-        currentCommand < getCurrentPatternSize())
-    {
-        Command currentCmd = pattern[currentCommand];
-        if ((strcmp(event, "MOVE_X") == 0 &&
-             (currentCmd.type == 'X' || currentCmd.type == 'M')) ||
-            (strcmp(event, "MOVE_Y") == 0 &&
-             (currentCmd.type == 'Y' || currentCmd.type == 'N')))
-        {
-            float duration = calculateMovementDuration(currentCmd);
-            status += "|distance=" + String(abs(currentCmd.value), 3);
+    bool inPattern = currentSide >= 0 && currentCommand >= 0 &&
+                     currentCommand < getCurrentPatternSize();
+    bool moveX = strcmp(event, "MOVE_X") == 0;
+    bool moveY = strcmp(event, "MOVE_Y") == 0;
+    if (inPattern && (moveX || moveY))
+    {
+        JobStep step = getCurrentStep(currentCommand);
+        bool isXAxis = step.type == 'X' || step.type == 'M';
+        bool isYAxis = step.type == 'Y' || step.type == 'N';
+        if ((moveX && isXAxis) || (moveY && isYAxis))
+        {
+            // Compiled moves were timed at the start; relative moves of a
+            // job generated as it runs are estimated here
+            float value = getMoveValue(currentCommand);
+            float duration =
+                jobImageValid
+                    ? step.seconds * 1000.0f
+                    : calculateMovementDuration(
+                          getCurrentCommand(currentCommand));
+            status += "|distance=" + String(fabsf(value), 3);
             status += "|direction=" +
-                      String(currentCmd.value < 0 ? "negative" : "positive");
-            status += "|spray=" + String(currentCmd.sprayOn ? "on" : "off");
+                      String(value < 0 ? "negative" : "positive");
+            status += "|spray=" + String(step.sprayOn ? "on" : "off");
             status += "|duration_ms=" + String(duration, 2);
             // Add movement direction indicator
-            status +=
-                "|movement_axis=" +
-                String(currentCmd.type == 'X' || currentCmd.type == 'M' ? "X"
-                                                                        : "Y");
+            status += "|movement_axis=" + String(isXAxis ? "X" : "Y");
         }
-    }
 
-    // Add row transition details for Y movements
-    if (strcmp(event, "MOVE_Y") == 0 && pattern != nullptr)
-    {
-        Command currentCmd = pattern[currentCommand];
-        if (currentCmd.type == 'Y' || currentCmd.type == 'N')
+        // Add row transition details for Y movements
+        if (moveY && isYAxis)
         {
             int targetRow =
                 currentRow +
-                (currentCmd.value > 0 ? 2 : 0);  // +2 for positive moves (next
-                                                 // row), same for negative
+                (getMoveValue(currentCommand) > 0 ? 2 : 0);  // +2 for positive
+                                                            // moves (next row)
             status += "|details=to_row_" + String(targetRow);
         }
     }
@@ -63,34 +186,19 @@ void PatternExecutor::reportStatus(const char* event, const String& details)
     Serial.println(status);
 }
 
-// Rest of the file remains unchanged
 float PatternExecutor::calculateMovementDuration(const Command& cmd) const
 {
-    // Get current speeds and steps per inch from MovementController
-    float distance = abs(cmd.value);  // Distance in inches
-    float steps;
-    float speed;
-
-    // Calculate steps and get appropriate speed based on command type
-    if (cmd.type == 'X' || cmd.type == 'M')
-    {
-        steps = distance * X_STEPS_PER_INCH;
-        // Use pattern-specific speed if available
-        speed = movementController.getCurrentXSpeed();
-    }
-    else if (cmd.type == 'Y' || cmd.type == 'N')
-    {
-        steps = distance * Y_STEPS_PER_INCH;
-        speed = Y_SPEED;  // Y movements always use default speed
-    }
-    else
+    // Relative moves only; absolute ones depend on where the head is
+    bool isXAxis = cmd.type == 'X' || cmd.type == 'M';
+    if (!isXAxis && cmd.type != 'Y' && cmd.type != 'N')
     {
         return 0.0;  // Not a movement command
     }
-
-    // Calculate duration in milliseconds
-    // Duration = (steps / steps_per_second) * 1000
-    return (steps / speed) * 1000.0;
+    long steps = isXAxis ? XAxis::toSteps(fabsf(cmd.value))
+                         : YAxis::toSteps(fabsf(cmd.value));
+    return movementController.estimateMoveSeconds(isXAxis, steps, cmd.sprayOn,
+                                                  getCurrentPatternName()) *
+           1000.0;
 }
 
 PatternExecutor::PatternExecutor(MovementController& movement,
@@ -104,29 +212,68 @@ PatternExecutor::PatternExecutor(MovementController& movement,
       executingSingleSide(false),
       stopped(false),
       currentRow(0),
-      currentPattern(nullptr),
-      cachedPatternSide(-1)
+      plan(),
+      planIndex(0),
+      cachedPlan(),
+      cachedPlanSide(-1),
+      cachedPlanFrom(),
+      planValid(false),
+      transitionCost(),
+      jobImageValid(false),
+      approachSecondsLeft(0),
+      paintingSecondsLeft(0),
+      laterSeconds(),
+      overlapRotation(false),
+      sprayArmed(false)
 {
 }
 
-PatternExecutor::~PatternExecutor() { delete[] currentPattern; }
-
 void PatternExecutor::update()
 {
-    if (stopped || movementController.isMoving() ||
-        movementController.isPaused())
+    if (stopped || movementController.isPaused())
     {
         return;
     }
 
-    Command* pattern = getCurrentPattern();
     int patternSize = getCurrentPatternSize();
 
-    if (currentCommand < patternSize)
+    // Plan ahead: keep the motion queue topped up so the next segment is
+    // ready the moment the current one finishes
+    while (currentCommand < patternSize)
     {
-        processNextCommand();
+        // The part has to be square to the gun before painting, so only the
+        // approach to the side's start may run while it is still turning
+        if (movementController.isRotating() &&
+            !(overlapRotation && currentCommand < APPROACH_COMMANDS))
+        {
+            movementController.setStreaming(false);
+            return;
+        }
+
+        if (isQueuedCommand(getCurrentStep(currentCommand).type))
+        {
+            if (movementController.isQueueFull())
+            {
+                return;
+            }
+        }
+        else if (movementController.isGantryMoving())
+        {
+            // Servo commands wait for queued motion to drain
+            movementController.setStreaming(false);
+            return;
+        }
+
+        if (!processNextCommand())
+        {
+            return;
+        }
     }
-    else
+
+    // Every command of the side has been handed off; finish the side once
+    // the queued motion has drained
+    movementController.setStreaming(false);
+    if (!movementController.isMoving())
     {
         reportStatus("SIDE_COMPLETE", "");
         currentCommand = 0;
@@ -147,11 +294,9 @@ void PatternExecutor::update()
         }
         else
         {
-            // Find next enabled side
-            do
-            {
-                currentSide++;
-            } while (currentSide < 5 && !isSideEnabled(currentSide));
+            // Next side in the planned order
+            planIndex++;
+            currentSide = planIndex < plan.count ? plan.sides[planIndex] : 5;
 
             if (currentSide >= 5)
             {
@@ -163,9 +308,9 @@ void PatternExecutor::update()
 
                 long homePos = homingController.getHomeRotationPosition();
 
-                // Return rotation to home position using absolute position
-                Command rotateHome('R', homePos, true);
-                movementController.executeCommand(rotateHome);
+                // Return the table to its home index the shorter way; the
+                // step count is exact, so there is no need to unwind
+                movementController.rotateToIndex(RotationAxis::index(homePos));
 
                 // Add post-command debug
                 Serial.print(F("Post-command rotation steps: "));
@@ -185,34 +330,12 @@ void PatternExecutor::update()
             }
             else
             {
-                // Calculate rotation needed for next side
-                int targetRotation = 0;
-                switch (currentSide)
-                {
-                    case 1:  // Going to BACK
-                        targetRotation = 180;
-                        break;
-                    case 2:  // Going to LEFT
-                        targetRotation = 90;
-                        break;
-                    case 3:  // Going to RIGHT
-                        targetRotation = 270;
-                        break;
-                    case 4:  // Going to LIP
-                        targetRotation =
-                            90;  // LIP pattern starts from front position
-                        break;
-                }
-
-                if (targetRotation != currentRotation)
+                if (!rotateTo(sideRotation(currentSide, false)))
                 {
-                    int optimizedRotation =
-                        calculateOptimalRotation(targetRotation);
-
-                    Command rotateCmd('R', optimizedRotation, false);
-                    movementController.executeCommand(rotateCmd);
-                    currentRotation = targetRotation;
+                    stop();
+                    return;
                 }
+                beginSideTiming();
 
                 reportStatus("SIDE_CHANGE",
                              "moving_to_side_" + String(currentSide));
@@ -221,67 +344,693 @@ void PatternExecutor::update()
     }
 }
 
-void PatternExecutor::startPattern()
+bool PatternExecutor::startPattern()
 {
+    if (!checkSoftLimits(-1))
+    {
+        return false;
+    }
+
+    plan = getPlan(-1);
+    if (plan.count == 0)
+    {
+        reportStatus("ERROR", "no_sides_enabled");
+        return false;
+    }
+    compileJob();
+    timeJob(false);
+
     stopped = false;
-    currentSide = 0;
+    planIndex = 0;
+    currentSide = plan.sides[0];
     currentCommand = 0;
     currentRow = 0;
-    currentRotation = 0;  // Reset rotation tracking
     executingSingleSide = false;
     targetSide = -1;
+    sprayArmed = false;
+    overlapRotation = false;
+    movementController.resetQueueStats();
+
+    // Square the first side to the gun, wherever the last part left the
+    // table
+    if (!rotateTo(sideRotation(currentSide, false)))
+    {
+        stop();
+        return false;
+    }
+    beginSideTiming();
+    reportPlan();
     reportStatus("PATTERN_START", "full_pattern");
+    return true;
 }
 
-void PatternExecutor::startSingleSide(int side)
+bool PatternExecutor::startSingleSide(int side)
 {
     if (side >= 0 && side < 5 &&
         isSideEnabled(side))  // Check if side is enabled
     {
+        if (!checkSoftLimits(side))
+        {
+            return false;
+        }
+        plan = getPlan(side);
+        compileJob();
+        timeJob(true);
+
         stopped = false;
+        planIndex = 0;
         currentSide = side;
         currentCommand = 0;
         currentRow = 0;
         executingSingleSide = true;
         targetSide = side;
-        currentRotation = 0;  // Reset rotation tracking when starting any side
+        sprayArmed = false;
+        movementController.resetQueueStats();
 
-        // Calculate required rotation for the requested side
-        int targetRotation;
-        switch (side)
+        if (!rotateTo(sideRotation(side, true)))
         {
-            case 0:  // FRONT
-                targetRotation = 0;
-                break;
-            case 1:  // BACK
-                targetRotation = 180;
-                break;
-            case 2:  // LEFT
-                targetRotation = 90;
-                break;
-            case 3:  // RIGHT
-                targetRotation = 270;
-                break;
-            case 4:                  // LIP
-                targetRotation = 0;  // LIP pattern starts from front position
-                break;
+            stop();
+            return false;
         }
+        beginSideTiming();
+        reportPlan();
 
-        // Optimize rotation direction
-        int optimizedRotation = calculateOptimalRotation(targetRotation);
+        reportStatus("PATTERN_START", "single_side");
+        return true;
+    }
 
-        // Execute optimized rotation
-        Command rotateCmd('R', optimizedRotation, false);
-        movementController.executeCommand(rotateCmd);
-        currentRotation = targetRotation;  // Update current rotation
+    reportStatus("ERROR", side >= 0 && side < 5 ? "side_disabled"
+                                                : "invalid_side_selected");
+    return false;
+}
 
-        reportStatus("PATTERN_START", "single_side");
+bool PatternExecutor::checkSoftLimits(int side)
+{
+    for (int s = 0; s < 5; s++)
+    {
+        if (side >= 0 ? s != side : !isSideEnabled(s))
+        {
+            continue;
+        }
+
+        int row = 0;
+        char axis = 0;
+        if (findLimitViolation(s, row, axis))
+        {
+            Serial.print(F("ERROR: Job leaves the soft limits on side "));
+            Serial.print(sideName(s));
+            Serial.print(F(", row "));
+            Serial.print(row);
+            Serial.print(F(", axis "));
+            Serial.println(axis);
+            reportStatus("PREFLIGHT_FAILED", String("side_") + sideName(s) +
+                                                 "_row_" + String(row) +
+                                                 "_axis_" + String(axis));
+            return false;
+        }
     }
-    else
+    return true;
+}
+
+bool PatternExecutor::findLimitViolation(int side, int& row, char& axis) const
+{
+    if (settings.builtInPatterns)
+    {
+        // Every move of the table once the head is at its start. Row 0 is
+        // the move to the start; each pass and the step over after it are
+        // counted as its row.
+        long pos[2] = {0, 0};
+        row = 0;
+        int size = calculatePatternSize(side);
+        for (int i = 0; i < size; i++)
+        {
+            Command cmd = commandAt(side, i, 0);
+            if (applyMove(cmd, pos) < 0 || i < APPROACH_COMMANDS - 1)
+            {
+                continue;
+            }
+            row += cmd.sprayOn ? 1 : 0;
+            axis = axisOutsideLimits(pos[0], pos[1]);
+            if (axis)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    float startX = 0;
+    float startY = 0;
+    float travelX = 0;
+    float travelY = 0;
+    getSideStart(side, 0, startX, startY);
+    getSideTravel(side, travelX, travelY);
+
+    // The other corners paint the same passes, so one walk covers them.
+    // Settings are converted once; the walk itself is the same whole
+    // micro-inch arithmetic the planner uses for the real moves. Row 0 is
+    // the move to the side's start.
+    long pos[2] = {inchesToMicros(startX), inchesToMicros(startY)};
+    row = 0;
+    axis = axisOutsideLimits(pos[0], pos[1]);
+    if (axis)
+    {
+        return true;
+    }
+
+    // The lip sweeps in Y and steps over in X, the other sides the reverse
+    bool lip = side == 4;
+    int sweepAxis = lip ? 1 : 0;
+    long sweep = inchesToMicros((lip ? travelY : travelX) +
+                                2 * settings.sprayRunUp);
+    long stepOver = inchesToMicros(lip ? travelX : travelY);
+    if (side == 1 || side == 3)
+    {
+        stepOver = -stepOver;  // Back and right work downwards
+    }
+
+    int rows = getSideRows(side);
+    for (row = 1; row <= rows; row++)
+    {
+        if (row > 1)
+        {
+            pos[1 - sweepAxis] += stepOver;
+            axis = axisOutsideLimits(pos[0], pos[1]);
+            if (axis)
+            {
+                return true;
+            }
+        }
+
+        pos[sweepAxis] += row % 2 == 1 ? sweep : -sweep;
+        axis = axisOutsideLimits(pos[0], pos[1]);
+        if (axis)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PatternExecutor::rotateTo(int targetRotation)
+{
+    // The controller picks the shorter way from the table's exact position
+    if (!movementController.rotateToAngle(targetRotation))
+    {
+        reportStatus("ERROR", "rotation_wind_limit");
+        return false;
+    }
+
+    float toX = 0;
+    float toY = 0;
+    getSideStart(currentSide, plan.corners[currentSide], toX, toY);
+    overlapRotation = approachKeepsClear(
+        XAxis::toUnits(movementController.getCurrentXSteps()),
+        YAxis::toUnits(movementController.getCurrentYSteps()), toX, toY);
+    reportStatus("ROTATION_OVERLAP", overlapRotation ? "yes" : "no");
+    return true;
+}
+
+void PatternExecutor::getSideStart(int side, uint8_t corner, float& x,
+                                   float& y) const
+{
+    if (settings.builtInPatterns)
+    {
+        // The tables open with the moves to their one start
+        x = builtInPatternCommand(side, 0).value;
+        y = builtInPatternCommand(side, 1).value;
+        return;
+    }
+
+    switch (side)
+    {
+        case 0:  // FRONT
+            x = settings.initialOffsets.front.x;
+            y = settings.initialOffsets.front.y;
+            break;
+        case 1:  // BACK
+            x = settings.initialOffsets.back.x;
+            y = settings.initialOffsets.back.y;
+            break;
+        case 2:  // LEFT
+            x = settings.initialOffsets.left.x;
+            y = settings.initialOffsets.left.y;
+            break;
+        case 3:  // RIGHT
+            x = settings.initialOffsets.right.x;
+            y = settings.initialOffsets.right.y;
+            break;
+        default:  // LIP
+            x = settings.initialOffsets.lip.x;
+            y = settings.initialOffsets.lip.y;
+            break;
+    }
+
+    // Passes begin a run-up before the painted area. The lip sweeps in Y
+    // and steps over in X, the other sides the reverse.
+    bool lip = side == 4;
+    float& sweepStart = lip ? y : x;
+    float& rowStart = lip ? x : y;
+    sweepStart -= settings.sprayRunUp;
+
+    float travelX = 0;
+    float travelY = 0;
+    getSideTravel(side, travelX, travelY);
+    if (corner & FLIP_SWEEP)
+    {
+        sweepStart += (lip ? travelY : travelX) + 2 * settings.sprayRunUp;
+    }
+    if (corner & FLIP_ROWS)
+    {
+        float rows = (lip ? travelX : travelY) * (getSideRows(side) - 1);
+        rowStart += side == 1 || side == 3 ? -rows : rows;
+    }
+}
+
+void PatternExecutor::getSideFinish(int side, uint8_t corner, float& x,
+                                    float& y) const
+{
+    if (settings.builtInPatterns)
+    {
+        // Wherever the table's moves leave the head
+        long pos[2] = {0, 0};
+        int size = calculatePatternSize(side);
+        for (int i = 0; i < size; i++)
+        {
+            applyMove(commandAt(side, i, corner), pos);
+        }
+        x = microsToInches(pos[0]);
+        y = microsToInches(pos[1]);
+        return;
+    }
+
+    // A side finishes in the corner it starts from, mirrored along the
+    // passes after an odd number of them and across the rows if there is
+    // more than one
+    int rows = getSideRows(side);
+    corner ^= (rows % 2 == 1 ? FLIP_SWEEP : 0) | (rows > 1 ? FLIP_ROWS : 0);
+    getSideStart(side, corner, x, y);
+}
+
+float PatternExecutor::getSideAngle(int side) const
+{
+    switch (side)
+    {
+        case 0:  // FRONT
+            return settings.initialOffsets.front.angle;
+        case 1:  // BACK
+            return settings.initialOffsets.back.angle;
+        case 2:  // LEFT
+            return settings.initialOffsets.left.angle;
+        case 3:  // RIGHT
+            return settings.initialOffsets.right.angle;
+        default:  // LIP
+            return settings.initialOffsets.lip.angle;
+    }
+}
+
+void PatternExecutor::getSideTravel(int side, float& x, float& y) const
+{
+    switch (side)
     {
-        reportStatus("ERROR", side >= 0 && side < 5 ? "side_disabled"
-                                                    : "invalid_side_selected");
+        case 0:  // FRONT
+        case 1:  // BACK
+            x = settings.travelDistance.vertical.x;
+            y = settings.travelDistance.vertical.y;
+            break;
+        case 2:  // LEFT
+        case 3:  // RIGHT
+            x = settings.travelDistance.horizontal.x;
+            y = settings.travelDistance.horizontal.y;
+            break;
+        default:  // LIP
+            x = settings.travelDistance.lip.x;
+            y = settings.travelDistance.lip.y;
+            break;
+    }
+}
+
+int PatternExecutor::getSideRows(int side) const
+{
+    return (side == 2 || side == 3) ? settings.rows.x : settings.rows.y;
+}
+
+bool PatternExecutor::approachKeepsClear(float fromX, float fromY, float toX,
+                                         float toY) const
+{
+    const float xMin = settings.rotationKeepOut.xMin;
+    const float yMin = settings.rotationKeepOut.yMin;
+    const float xMax = settings.rotationKeepOut.xMax;
+    const float yMax = settings.rotationKeepOut.yMax;
+    if (xMax <= xMin || yMax <= yMin)
+    {
+        return true;  // No keep-out area set
     }
+
+    // The approach moves X at the current height first, then Y. Each leg is
+    // axis aligned, so it enters the area exactly when its bounding box
+    // overlaps it.
+    bool xLegEnters = min(fromX, toX) <= xMax && max(fromX, toX) >= xMin &&
+                      fromY <= yMax && fromY >= yMin;
+    bool yLegEnters = min(fromY, toY) <= yMax && max(fromY, toY) >= yMin &&
+                      toX <= xMax && toX >= xMin;
+    return !xLegEnters && !yLegEnters;
+}
+
+float PatternExecutor::estimateJobSeconds(int side) const
+{
+    long pos[2] = {XAxis::stepsToMicros(movementController.getCurrentXSteps()),
+                   YAxis::stepsToMicros(movementController.getCurrentYSteps())};
+    long table = movementController.getCurrentRotationSteps();
+    return estimateFrom(getPlan(side), 0, 0, side >= 0, pos, table);
+}
+
+float PatternExecutor::estimateRemainingSeconds() const
+{
+    // Past the last side, as PATTERN_COMPLETE is reported, nothing is left
+    if (stopped || currentSide < 0 || currentSide >= 5 || currentCommand < 0 ||
+        planIndex >= plan.count)
+    {
+        return 0;
+    }
+
+    // What is queued, then the commands not handed off yet
+    float queued = movementController.estimateQueuedSeconds();
+    long table = movementController.getCurrentRotationSteps();
+    if (!jobImageValid)
+    {
+        // Generated as it runs, so walk what is left. The walk of the side
+        // starts from its own absolute moves, so the head's position only
+        // matters before those.
+        long pos[2] = {
+            XAxis::stepsToMicros(movementController.getCurrentXSteps()),
+            YAxis::stepsToMicros(movementController.getCurrentYSteps())};
+        return queued + estimateFrom(plan, planIndex, currentCommand,
+                                     executingSingleSide, pos, table);
+    }
+
+    // The table turns before the side's first command, which the approach
+    // may overlap
+    float approach = max(approachSecondsLeft, 0.0f);
+    float side = max(paintingSecondsLeft, 0.0f) + approach;
+    if (currentCommand == 0)
+    {
+        long delta = RotationAxis::shortestDelta(
+            table, sideIndex(currentSide, executingSingleSide));
+        float rotation = movementController.estimateRotationSeconds(delta);
+        side += overlapRotation ? max(rotation - approach, 0.0f) : rotation;
+    }
+    return queued + side + laterSeconds[planIndex];
+}
+
+float PatternExecutor::estimateFrom(const JobPlan& job, int slot,
+                                    int fromCommand, bool singleSide,
+                                    long pos[2], long table) const
+{
+    float seconds = 0;
+    for (; slot < job.count; slot++)
+    {
+        int side = job.sides[slot];
+        uint8_t corner = job.corners[side];
+
+        // The table turns before each side, which the approach may overlap
+        float rotation = 0;
+        if (fromCommand == 0)
+        {
+            long delta = RotationAxis::shortestDelta(
+                table, sideIndex(side, singleSide));
+            rotation = movementController.estimateRotationSeconds(delta);
+            table += delta;
+        }
+        float startX = 0;
+        float startY = 0;
+        getSideStart(side, corner, startX, startY);
+        bool overlap = approachKeepsClear(microsToInches(pos[0]),
+                                          microsToInches(pos[1]), startX,
+                                          startY);
+
+        float approach = 0;
+        float painting = 0;
+        String pattern = sideName(side);
+        int size = calculatePatternSize(side);
+        for (int i = 0; i < size; i++)
+        {
+            Command cmd = commandAt(side, i, corner);
+            float& phase = i < APPROACH_COMMANDS ? approach : painting;
+            if (cmd.type == 'S')
+            {
+                if (i >= fromCommand)
+                {
+                    phase += SERVO_SETTLE_MS / 1000.0f;
+                }
+                continue;
+            }
+
+            int axis = cmd.type == 'X' || cmd.type == 'M' ? 0 : 1;
+            long from = pos[axis];
+            switch (cmd.type)
+            {
+                case 'X':
+                case 'Y':
+                    pos[axis] += inchesToMicros(cmd.value);
+                    break;
+                case 'M':
+                case 'N':
+                    pos[axis] = inchesToMicros(cmd.value);
+                    break;
+                default:
+                    continue;  // Spray commands take no time
+            }
+            if (i < fromCommand)
+            {
+                continue;  // Already done, only its position counts
+            }
+
+            long steps = axis == 0 ? XAxis::microsToSteps(pos[0]) -
+                                         XAxis::microsToSteps(from)
+                                   : YAxis::microsToSteps(pos[1]) -
+                                         YAxis::microsToSteps(from);
+            phase += movementController.estimateMoveSeconds(
+                axis == 0, steps, cmd.sprayOn, pattern);
+        }
+
+        seconds += (overlap ? max(rotation, approach) : rotation + approach) +
+                   painting;
+        fromCommand = 0;
+    }
+    if (singleSide)
+    {
+        return seconds;
+    }
+
+    // The table goes back to its home index before homing, which is not
+    // counted
+    long home = RotationAxis::index(homingController.getHomeRotationPosition());
+    return seconds + movementController.estimateRotationSeconds(
+                         RotationAxis::shortestDelta(table, home));
+}
+
+PatternExecutor::JobPlan PatternExecutor::planJob(int side) const
+{
+    JobPlan best = {};
+    int candidates[5];
+    int count = 0;
+    for (int s = 0; s < 5; s++)
+    {
+        if (side >= 0 ? s == side : isSideEnabled(s))
+        {
+            candidates[count++] = s;
+        }
+    }
+    if (count == 0)
+    {
+        return best;
+    }
+
+    // Painting a side takes the same time from any corner, so only the
+    // moves between sides count. The built-in tables start from one corner.
+    const bool single = side >= 0;
+    const uint8_t corners = settings.builtInPatterns ? 1 : 4;
+    float finishX[5][4];
+    float finishY[5][4];
+    for (int i = 0; i < count; i++)
+    {
+        for (uint8_t corner = 0; corner < corners; corner++)
+        {
+            getSideFinish(candidates[i], corner, finishX[i][corner],
+                          finishY[i][corner]);
+        }
+    }
+
+    // Every move a plan can make, timed once: from the head to each side's
+    // corners, from each side, by the corner it started from, to each
+    // corner of every other side, and after a full job back home, where the
+    // table returns and the head is homed (weighed as a rapid move to the
+    // home corner)
+    float headX = XAxis::toUnits(movementController.getCurrentXSteps());
+    float headY = YAxis::toUnits(movementController.getCurrentYSteps());
+    long table = movementController.getCurrentRotationSteps();
+    long home = RotationAxis::index(homingController.getHomeRotationPosition());
+    float firstCost[5][4];
+    float homeTurn[5];
+    float homeRun[5][4][2];  // X then Y
+    for (int i = 0; i < count; i++)
+    {
+        long sideTable = sideIndex(candidates[i], single);
+        homeTurn[i] = movementController.estimateRotationSeconds(
+            RotationAxis::shortestDelta(sideIndex(candidates[i], false),
+                                        home));
+        for (uint8_t corner = 0; corner < corners; corner++)
+        {
+            firstCost[i][corner] = transitionSeconds(
+                headX, headY, table, candidates[i], corner, single);
+
+            float endX = finishX[i][corner];
+            float endY = finishY[i][corner];
+            homeRun[i][corner][0] = movementController.estimateRapidSeconds(
+                true, XAxis::toSteps(endX));
+            homeRun[i][corner][1] = movementController.estimateRapidSeconds(
+                false, YAxis::toSteps(endY));
+            for (int j = 0; j < count; j++)
+            {
+                for (uint8_t next = 0; next < corners && j != i; next++)
+                {
+                    transitionCost[i][corner][j][next] = transitionSeconds(
+                        endX, endY, sideTable, candidates[j], next, single);
+                }
+            }
+        }
+    }
+
+    // Every order of the sides, and for each the best corners found by
+    // working forward through it, keeping the cheapest way to have painted
+    // each side so far starting from each corner. Orders are taken with the
+    // last side changing slowest, so ties go the same way they always have.
+    int digits[5];  // The order back to front
+    for (int i = 0; i < count; i++)
+    {
+        digits[i] = i;
+    }
+    float bestCost = -1;
+    do
+    {
+        int order[5];
+        for (int i = 0; i < count; i++)
+        {
+            order[i] = digits[count - 1 - i];
+        }
+
+        float cost[5][4];
+        uint8_t previousCorner[5][4] = {};
+        for (uint8_t corner = 0; corner < corners; corner++)
+        {
+            cost[0][corner] = firstCost[order[0]][corner];
+        }
+        for (int i = 1; i < count; i++)
+        {
+            int previous = order[i - 1];
+            for (uint8_t corner = 0; corner < corners; corner++)
+            {
+                cost[i][corner] = -1;
+                for (uint8_t last = 0; last < corners; last++)
+                {
+                    float total =
+                        cost[i - 1][last] +
+                        transitionCost[previous][last][order[i]][corner];
+                    if (cost[i][corner] < 0 || total < cost[i][corner])
+                    {
+                        cost[i][corner] = total;
+                        previousCorner[i][corner] = last;
+                    }
+                }
+            }
+        }
+
+        int lastSide = order[count - 1];
+        for (uint8_t corner = 0; corner < corners; corner++)
+        {
+            float total = cost[count - 1][corner];
+            if (!single)
+            {
+                total += homeTurn[lastSide];
+                total += homeRun[lastSide][corner][0];
+                total += homeRun[lastSide][corner][1];
+            }
+            if (bestCost >= 0 && total >= bestCost)
+            {
+                continue;
+            }
+
+            // Keep this order, following the corners back from the end
+            bestCost = total;
+            best.count = count;
+            uint8_t at = corner;
+            for (int i = count - 1; i >= 0; i--)
+            {
+                best.sides[i] = candidates[order[i]];
+                best.corners[best.sides[i]] = at;
+                at = previousCorner[i][at];
+            }
+        }
+    } while (nextPermutation(digits, count));
+    return best;
+}
+
+const PatternExecutor::JobPlan& PatternExecutor::getPlan(int side) const
+{
+    long from[5] = {
+        movementController.getCurrentXSteps(),
+        movementController.getCurrentYSteps(),
+        movementController.getCurrentRotationSteps(),
+        RotationAxis::index(homingController.getHomeRotationPosition()),
+        static_cast<long>(movementController.getEstimateRevision())};
+    if (!planValid || side != cachedPlanSide ||
+        memcmp(from, cachedPlanFrom, sizeof(from)) != 0)
+    {
+        cachedPlan = planJob(side);
+        cachedPlanSide = side;
+        memcpy(cachedPlanFrom, from, sizeof(from));
+        planValid = true;
+    }
+    return cachedPlan;
+}
+
+float PatternExecutor::transitionSeconds(float fromX, float fromY,
+                                         long fromTable, int side,
+                                         uint8_t corner, bool singleSide) const
+{
+    float toX = 0;
+    float toY = 0;
+    getSideStart(side, corner, toX, toY);
+
+    // The approach is an X move then a Y move with the spray off; the table
+    // turns the shorter way meanwhile
+    float approach =
+        movementController.estimateRapidSeconds(
+            true, XAxis::toSteps(toX) - XAxis::toSteps(fromX)) +
+        movementController.estimateRapidSeconds(
+            false, YAxis::toSteps(toY) - YAxis::toSteps(fromY));
+    float rotation = movementController.estimateRotationSeconds(
+        RotationAxis::shortestDelta(fromTable, sideIndex(side, singleSide)));
+    return approachKeepsClear(fromX, fromY, toX, toY)
+               ? max(approach, rotation)
+               : approach + rotation;
+}
+
+void PatternExecutor::reportPlan()
+{
+    // For example FRONT:0>LEFT:3, each side with its start corner
+    String order;
+    for (int i = 0; i < plan.count; i++)
+    {
+        if (i > 0)
+        {
+            order += ">";
+        }
+        order += String(sideName(plan.sides[i])) + ":" +
+                 String(plan.corners[plan.sides[i]]);
+    }
+    reportStatus("JOB_PLAN", order);
 }
 
 bool PatternExecutor::isExecuting() const
@@ -289,39 +1038,82 @@ bool PatternExecutor::isExecuting() const
     return currentCommand >= 0 || currentSide >= 0 || executingSingleSide;
 }
 
-Command* PatternExecutor::getCurrentPattern() const
+Command PatternExecutor::getCurrentCommand(int index) const
+{
+    return commandAt(currentSide, index, plan.corners[currentSide]);
+}
+
+PatternExecutor::JobStep PatternExecutor::getCurrentStep(int index) const
 {
-    if (currentPattern == nullptr || cachedPatternSide != currentSide)
+    if (jobImageValid)
+    {
+        return jobImage[sideImageStart[currentSide] + index];
+    }
+    Command cmd = getCurrentCommand(index);
+    JobStep step = {0, 0, cmd.type, cmd.sprayOn};
+    return step;
+}
+
+float PatternExecutor::getMoveValue(int index) const
+{
+    if (!jobImageValid)
+    {
+        return getCurrentCommand(index).value;
+    }
+
+    // The position of an absolute move; a relative one is the distance from
+    // the side's previous target on the same axis, which always exists as
+    // every side starts with absolute moves
+    const JobStep* side = jobImage + sideImageStart[currentSide];
+    bool isXAxis = side[index].type == 'X' || side[index].type == 'M';
+    long steps = side[index].target;
+    if (side[index].type == 'X' || side[index].type == 'Y')
     {
-        Serial.print(F("Generating new pattern for side: "));
-        Serial.println(currentSide);
-        delete[] currentPattern;
-        currentPattern = generatePattern(currentSide);
-        cachedPatternSide = currentSide;
+        for (int i = index - 1; i >= 0; i--)
+        {
+            char type = side[i].type;
+            bool sameAxis = isXAxis ? type == 'X' || type == 'M'
+                                    : type == 'Y' || type == 'N';
+            if (sameAxis)
+            {
+                steps -= side[i].target;
+                break;
+            }
+        }
     }
-    return currentPattern;
+    return isXAxis ? XAxis::toUnits(steps) : YAxis::toUnits(steps);
 }
 
 int PatternExecutor::getCurrentPatternSize() const
 {
+    if (jobImageValid && currentSide >= 0 && currentSide < 5)
+    {
+        return sideCommandCount[currentSide];
+    }
     return calculatePatternSize(currentSide);
 }
 
-void PatternExecutor::processNextCommand()
+bool PatternExecutor::isQueuedCommand(char type) const
 {
-    Command* pattern = getCurrentPattern();
-    if (pattern == nullptr)
+    return type == 'X' || type == 'Y' || type == 'M' || type == 'N' ||
+           type == 'P';
+}
+
+bool PatternExecutor::processNextCommand()
+{
+    if (currentSide < 0 || currentSide >= 5)
     {
         reportStatus("ERROR", "invalid_pattern");
-        return;
+        return false;
     }
+    JobStep step = getCurrentStep(currentCommand);
 
     // Add debug logging
     Serial.println(F("=== Processing Command ==="));
     Serial.print(F("Command index: "));
     Serial.println(currentCommand);
     Serial.print(F("Command type: "));
-    Serial.println(pattern[currentCommand].type);
+    Serial.println(step.type);
 
     // Only apply pattern speed if we're still executing (not stopped)
     if (!stopped)
@@ -329,46 +1121,89 @@ void PatternExecutor::processNextCommand()
         movementController.applyPatternSpeed(getCurrentPatternName());
     }
 
-    Command currentCmd = pattern[currentCommand];
-
     // Report movement events before execution
-    if (currentCmd.type == 'X' || currentCmd.type == 'M')
+    if (step.type == 'X' || step.type == 'M')
     {
         reportStatus("MOVE_X", "");
     }
-    else if (currentCmd.type == 'Y' || currentCmd.type == 'N')
+    else if (step.type == 'Y' || step.type == 'N')
     {
         reportStatus("MOVE_Y", "");
     }
 
-    if (currentCommand > 0)
+    // Track spray pattern progress. Every row after the first starts with
+    // the spray switched on after the step over, the one relative move
+    // made with the spray off.
+    if (step.type == 'P' && currentCommand > 0)
     {
-        Command prevCmd = pattern[currentCommand - 1];
-
-        // Track spray pattern progress
-        if (currentCmd == SPRAY_OFF())
+        JobStep previous = getCurrentStep(currentCommand - 1);
+        if (!step.sprayOn)
         {
             reportStatus("SPRAY_COMPLETE", "row_" + String(currentRow + 1));
         }
-        else if (currentCmd == SPRAY_ON() && (prevCmd == MOVE_Y(4.16, false) ||
-                                              prevCmd == MOVE_Y(-4.16, false) ||
-                                              prevCmd == MOVE_Y(4.415, false) ||
-                                              prevCmd == MOVE_Y(-4.415, false)))
+        else if ((previous.type == 'X' || previous.type == 'Y') &&
+                 !previous.sprayOn)
         {
             currentRow++;
             reportStatus("SPRAY_START", "row_" + String(currentRow + 1));
         }
     }
 
-    if (movementController.executeCommand(currentCmd))
+    // Spray commands ride along with the queued segments instead of
+    // switching the valve while earlier moves are still running
+    if (step.type == 'P')
     {
+        sprayArmed = step.sprayOn;
         currentCommand++;
+        return true;
+    }
+
+    bool queued = isQueuedCommand(step.type);
+    bool sprayOn = step.sprayOn;
+
+    // Painting passes spray between the run-ups only. The built-in tables
+    // have none.
+    if (queued && sprayOn && settings.sprayRunUp > 0 &&
+        !settings.builtInPatterns)
+    {
+        movementController.setSprayWindow(settings.sprayRunUp,
+                                          settings.sprayRunUp);
+    }
+
+    if (queued)
+    {
+        sprayOn = sprayOn || sprayArmed;
+        movementController.setStreaming(true);
+    }
+
+    bool executed = false;
+    if (queued && jobImageValid)
+    {
+        executed = movementController.queueStepMove(
+            step.type == 'X' || step.type == 'M', step.target, sprayOn);
     }
     else
     {
-        Serial.println(F("ERROR: Command execution failed"));
-        reportStatus("ERROR", "command_execution_failed");
+        // The servo is the one compiled command not queued
+        Command cmd = jobImageValid
+                          ? Command('S', getSideAngle(currentSide), false)
+                          : getCurrentCommand(currentCommand);
+        cmd.sprayOn = sprayOn;
+        executed = movementController.executeCommand(cmd);
+    }
+
+    if (executed)
+    {
+        float& left = currentCommand < APPROACH_COMMANDS ? approachSecondsLeft
+                                                         : paintingSecondsLeft;
+        left -= step.seconds;
+        currentCommand++;
+        return queued;
     }
+
+    Serial.println(F("ERROR: Command execution failed"));
+    reportStatus("ERROR", "command_execution_failed");
+    return false;
 }
 
 void PatternExecutor::stop()
@@ -380,204 +1215,239 @@ void PatternExecutor::stop()
     currentRow = 0;
     stopped = true;
 
-    // Clean up pattern
-    delete[] currentPattern;
-    currentPattern = nullptr;
-    cachedPatternSide = -1;
-
     reportStatus("PATTERN_STOPPED", "");
 }
 
 String PatternExecutor::getCurrentPatternName() const
 {
-    switch (currentSide)
-    {
-        case 0:
-            return "FRONT";
-        case 1:
-            return "BACK";
-        case 2:
-            return "LEFT";
-        case 3:
-            return "RIGHT";
-        case 4:
-            return "LIP";
-        default:
-            return "";
-    }
+    return sideName(currentSide);
 }
 
-int PatternExecutor::calculateOptimalRotation(int targetRotation)
+Command PatternExecutor::commandAt(int side, int index, uint8_t corner) const
 {
-    // Normalize current and target rotations to 0-359 range
-    currentRotation = ((currentRotation % 360) + 360) % 360;
-    targetRotation = ((targetRotation % 360) + 360) % 360;
-
-    // Calculate both clockwise and counterclockwise distances
-    int clockwiseDist = (targetRotation - currentRotation + 360) % 360;
-    int counterclockwiseDist = (currentRotation - targetRotation + 360) % 360;
-
-    // Choose the shorter rotation
-    if (clockwiseDist <= counterclockwiseDist)
+    // Every side is the servo angle, the move to the start, then four
+    // commands a row: spray on, the pass, spray off and the step over to the
+    // next row, which the last row leaves out
+    if (index == 0)
     {
-        return clockwiseDist;
+        return Command('S', getSideAngle(side), false);  // 'S' for servo
     }
-    else
+    if (settings.builtInPatterns)
     {
-        return -counterclockwiseDist;
+        return builtInPatternCommand(side, index - 1);  // After the servo
     }
-}
-
-Command* PatternExecutor::generatePattern(int side) const
-{
-    Serial.println(F("=== Pattern Generation Settings ==="));
-    Serial.print(F("Side: "));
-    Serial.println(side);
 
     float xOffset = 0;
     float yOffset = 0;
-    float angle = 0;
-    float xTravel = 0;
-    float yTravel = 0;
-
-    switch (side)
+    if (index <= 2)
     {
-        case 0:  // FRONT
-            Serial.println(F("Generating FRONT pattern"));
-            xOffset = settings.initialOffsets.front.x;
-            yOffset = settings.initialOffsets.front.y;
-            angle = settings.initialOffsets.front.angle;
-            xTravel = settings.travelDistance.vertical.x;
-            yTravel = settings.travelDistance.vertical.y;
-            break;
-        case 1:  // BACK
-            Serial.println(F("Generating BACK pattern"));
-            xOffset = settings.initialOffsets.back.x;
-            yOffset = settings.initialOffsets.back.y;
-            angle = settings.initialOffsets.back.angle;
-            xTravel = settings.travelDistance.vertical.x;
-            yTravel = settings.travelDistance.vertical.y;
-            break;
-        case 2:  // LEFT
-            Serial.println(F("Generating LEFT pattern"));
-            xOffset = settings.initialOffsets.left.x;
-            yOffset = settings.initialOffsets.left.y;
-            angle = settings.initialOffsets.left.angle;
-            xTravel = settings.travelDistance.horizontal.x;
-            yTravel = settings.travelDistance.horizontal.y;
-            break;
-        case 3:  // RIGHT
-            Serial.println(F("Generating RIGHT pattern"));
-            xOffset = settings.initialOffsets.right.x;
-            yOffset = settings.initialOffsets.right.y;
-            angle = settings.initialOffsets.right.angle;
-            xTravel = settings.travelDistance.horizontal.x;
-            yTravel = settings.travelDistance.horizontal.y;
-            break;
-        case 4:  // LIP
-            Serial.println(F("Generating LIP pattern"));
-            xOffset = settings.initialOffsets.lip.x;  // Use lip offsets as base
-            yOffset = settings.initialOffsets.lip.y;
-            angle = settings.initialOffsets.lip.angle;
-            xTravel = settings.travelDistance.lip.x;
-            yTravel = settings.travelDistance.lip.y;
-            break;
+        getSideStart(side, corner, xOffset, yOffset);
+        return index == 1 ? MOVETO_X(xOffset, false)
+                          : MOVETO_Y(yOffset, false);
     }
 
-    Serial.println(F("Pattern settings:"));
-    Serial.print(F("X Offset: "));
-    Serial.print(xOffset);
-    Serial.print(F(" Y Offset: "));
-    Serial.println(yOffset);
-    Serial.print(F("X Travel: "));
-    Serial.print(xTravel);
-    Serial.print(F(" Y Travel: "));
-    Serial.println(yTravel);
-
-    int size = calculatePatternSize(side) + 1;  // Add 1 for servo command
-    Command* pattern = new Command[size];
-    int idx = 0;
-
-    // Add servo command at the start
-    Serial.print(F("Adding servo command with angle: "));
-    Serial.println(angle);
-    pattern[idx++] = Command('S', angle, false);  // 'S' for servo
-
-    // Initial positioning
-    pattern[idx++] = MOVETO_X(xOffset, false);
-    pattern[idx++] = MOVETO_Y(yOffset, false);
-
-    // Generate rows
-    int numRows = (side == 2 || side == 3) ? settings.rows.x : settings.rows.y;
-
-    if (side == 4)
-    {  // LIP pattern - uses columns instead of rows
-        for (int col = 0; col < numRows; col++)
+    int row = (index - 3) / 4;
+    float xTravel = 0;
+    float yTravel = 0;
+    getSideTravel(side, xTravel, yTravel);
+
+    // The lip sweeps in Y and steps over in X, the other sides the reverse.
+    // Passes overrun the painted area by the run-up at both ends; the spray
+    // window keeps the paint to the area itself. The start corner flips the
+    // direction of the passes and of the rows.
+    bool lip = side == 4;
+    switch ((index - 3) % 4)
+    {
+        case 0:
+            return SPRAY_ON();
+        case 1:
         {
-            // Start spray
-            pattern[idx++] = SPRAY_ON();
-
-            // Move vertically - Use Y movement for main motion
-            float dist = yTravel;
-            if (col % 2 == 1)
+            float dist = (lip ? yTravel : xTravel) + 2 * settings.sprayRunUp;
+            if ((row % 2 == 1) != ((corner & FLIP_SWEEP) != 0))
             {
-                dist = -dist;  // Alternate direction for each column
+                dist = -dist;  // Alternate direction for each pass
             }
-            pattern[idx++] = MOVE_Y(dist, true);
-
-            // Stop spray
-            pattern[idx++] = SPRAY_OFF();
-
-            // Move to next column if not last column
-            if (col < numRows - 1)
+            return lip ? MOVE_Y(dist, true) : MOVE_X(dist, true);
+        }
+        case 2:
+            return SPRAY_OFF();
+        default:
+        {
+            // Back and right work downwards
+            float dist = lip ? xTravel : yTravel;
+            bool downwards = !lip && (side == 1 || side == 3);
+            if (downwards != ((corner & FLIP_ROWS) != 0))
             {
-                pattern[idx++] =
-                    MOVE_X(xTravel, false);  // Short X movement to next column
+                dist = -dist;
             }
+            return lip ? MOVE_X(dist, false) : MOVE_Y(dist, false);
         }
     }
-    else
+}
+
+void PatternExecutor::compileJob()
+{
+    if (jobImageValid &&
+        memcmp(imageCorners, plan.corners, sizeof(imageCorners)) == 0)
     {
-        for (int row = 0; row < numRows; row++)
+        return;  // Settings and corners unchanged since the last job
+    }
+    jobImageValid = false;
+
+    int used = 0;
+    for (int side = 0; side < 5; side++)
+    {
+        int size = calculatePatternSize(side);
+        if (used + size > JOB_IMAGE_CAPACITY)
         {
-            // Start spray
-            pattern[idx++] = SPRAY_ON();
+            Serial.println(F("Job too big to compile, generating as it runs"));
+            return;
+        }
+        sideImageStart[side] = used;
+        sideCommandCount[side] = size;
 
-            // Move across - Use X movement instead of Y
-            float dist = xTravel;
-            if (row % 2 == 1)
+        // The same whole micro-inch arithmetic executeCommand() uses, from
+        // the absolute moves to the side's start
+        long pos[2] = {0, 0};
+        for (int i = 0; i < size; i++)
+        {
+            Command cmd = commandAt(side, i, plan.corners[side]);
+            JobStep& step = jobImage[used + i];
+            step.target = 0;
+            step.seconds = 0;
+            step.type = cmd.type;
+            step.sprayOn = cmd.sprayOn;
+
+            int axis = cmd.type == 'X' || cmd.type == 'M' ? 0 : 1;
+            switch (cmd.type)
             {
-                dist = -dist;
+                case 'X':
+                case 'Y':
+                    pos[axis] += inchesToMicros(cmd.value);
+                    break;
+                case 'M':
+                case 'N':
+                    pos[axis] = inchesToMicros(cmd.value);
+                    break;
+                default:
+                    continue;  // Not a move
             }
-            pattern[idx++] =
-                MOVE_X(dist, true);  // Changed from MOVE_Y to MOVE_X
+            step.target = axis == 0 ? XAxis::microsToSteps(pos[0])
+                                    : YAxis::microsToSteps(pos[1]);
+        }
+        used += size;
+    }
 
-            // Stop spray
-            pattern[idx++] = SPRAY_OFF();
+    for (int side = 0; side < 5; side++)
+    {
+        imageCorners[side] = plan.corners[side];
+    }
+    jobImageValid = true;
+    Serial.print(F("Job compiled: "));
+    Serial.print(used);
+    Serial.println(F(" commands"));
+}
 
-            // Move to next row if not last row - Use Y movement instead of X
-            if (row < numRows - 1)
+void PatternExecutor::timeJob(bool singleSide)
+{
+    if (!jobImageValid)
+    {
+        return;
+    }
+
+    // In the planned order from where the head and table are now, so each
+    // approach starts where the side before it finished
+    long pos[2] = {movementController.getCurrentXSteps(),
+                   movementController.getCurrentYSteps()};
+    long table = movementController.getCurrentRotationSteps();
+    float slotSeconds[5];
+    for (int slot = 0; slot < plan.count; slot++)
+    {
+        int side = plan.sides[slot];
+        long delta =
+            RotationAxis::shortestDelta(table, sideIndex(side, singleSide));
+        float rotation = movementController.estimateRotationSeconds(delta);
+        table += delta;
+        float startX = 0;
+        float startY = 0;
+        getSideStart(side, plan.corners[side], startX, startY);
+        bool overlap = approachKeepsClear(XAxis::toUnits(pos[0]),
+                                          YAxis::toUnits(pos[1]), startX,
+                                          startY);
+
+        float approach = 0;
+        float painting = 0;
+        String pattern = sideName(side);
+        JobStep* steps = jobImage + sideImageStart[side];
+        for (int i = 0; i < sideCommandCount[side]; i++)
+        {
+            JobStep& step = steps[i];
+            if (step.type == 'S')
             {
-                float moveY = yTravel;
-                if (side == 1 || side == 3)
-                {  // BACK or RIGHT
-                    moveY =
-                        -moveY;  // Invert Y direction for back and right sides
-                }
-                pattern[idx++] =
-                    MOVE_Y(moveY, false);  // Changed from MOVE_X to MOVE_Y
+                step.seconds = SERVO_SETTLE_MS / 1000.0f;
+            }
+            else if (step.type != 'P')
+            {
+                int axis = step.type == 'X' || step.type == 'M' ? 0 : 1;
+                step.seconds = movementController.estimateMoveSeconds(
+                    axis == 0, step.target - pos[axis], step.sprayOn,
+                    pattern);
+                pos[axis] = step.target;
             }
+            (i < APPROACH_COMMANDS ? approach : painting) += step.seconds;
         }
+        slotSeconds[slot] =
+            (overlap ? max(rotation, approach) : rotation + approach) +
+            painting;
     }
 
-    return pattern;
+    // The table goes back to its home index after a full job; homing is
+    // not counted
+    float later = 0;
+    if (!singleSide)
+    {
+        long home =
+            RotationAxis::index(homingController.getHomeRotationPosition());
+        later = movementController.estimateRotationSeconds(
+            RotationAxis::shortestDelta(table, home));
+    }
+    for (int slot = plan.count - 1; slot >= 0; slot--)
+    {
+        laterSeconds[slot] = later;
+        later += slotSeconds[slot];
+    }
+}
+
+void PatternExecutor::beginSideTiming()
+{
+    approachSecondsLeft = 0;
+    paintingSecondsLeft = 0;
+    if (!jobImageValid)
+    {
+        return;
+    }
+    const JobStep* steps = jobImage + sideImageStart[currentSide];
+    for (int i = 0; i < sideCommandCount[currentSide]; i++)
+    {
+        (i < APPROACH_COMMANDS ? approachSecondsLeft : paintingSecondsLeft) +=
+            steps[i].seconds;
+    }
 }
 
 int PatternExecutor::calculatePatternSize(int side) const
 {
-    int numRows = (side == 2 || side == 3) ? settings.rows.x : settings.rows.y;
+    if (settings.builtInPatterns)
+    {
+        return 1 + builtInPatternSize(side);  // The servo, then the table
+    }
+
+    int numRows = getSideRows(side);
     // Size = servo command (1) + initial moves (2) + per row (spray on + move +
     // spray off + move to next row) * rows
+    if (numRows <= 0)
+    {
+        return 3;
+    }
     return 3 + (numRows * 4) -
            1;  // -1 because last row doesn't need vertical move
 }
@@ -597,6 +1467,7 @@ void PatternExecutor::setHorizontalTravel(float x, float y)
 
     settings.travelDistance.horizontal.x = x;
     settings.travelDistance.horizontal.y = y;
+    settingsChanged();
 
     // Verify the values were set correctly
     Serial.print(F("Verified values - X: "));
@@ -620,6 +1491,7 @@ void PatternExecutor::setVerticalTravel(float x, float y)
 
     settings.travelDistance.vertical.x = x;
     settings.travelDistance.vertical.y = y;
+    settingsChanged();
 
     // Verify the values were set correctly
     Serial.print(F("Verified values - X: "));
@@ -643,6 +1515,7 @@ void PatternExecutor::setLipTravel(float x, float y)
 
     settings.travelDistance.lip.x = x;
     settings.travelDistance.lip.y = y;
+    settingsChanged();
 
     // Verify the values were set correctly
     Serial.print(F("Verified values - X: "));
@@ -1,7 +1,10 @@
 // Patterns.cpp
 #include "Patterns.h"
 
-Command FRONT[] = {
+namespace
+{
+
+const PackedCommand FRONT[] = {
     // Initial Movement
     MOVETO_X(3.0 + .75, false),  // →3.0→ - Initial offset
     MOVETO_Y(0 + 2.75, false),   //
@@ -54,7 +57,7 @@ Command FRONT[] = {
     SPRAY_OFF(),           // ○ - Stop spray
 };
 
-Command BACK[] = {
+const PackedCommand BACK[] = {
     MOVETO_X(3.0 + .75, false),     // X offset
     MOVETO_Y(29.12 + 2.75, false),  // Y offset
 
@@ -106,7 +109,7 @@ Command BACK[] = {
     SPRAY_OFF(),           // ○ - Stop spray
 };
 
-Command LEFT[] = {
+const PackedCommand LEFT[] = {
     // Initial Movement
     MOVETO_X(1.0, false),         //
     MOVETO_Y(3.5 + 3.25, false),  // ↑3.5↑ Initial offset
@@ -147,7 +150,7 @@ Command LEFT[] = {
     SPRAY_OFF(),           // ○ - Stop spray
 };
 
-Command RIGHT[] = {
+const PackedCommand RIGHT[] = {
     MOVETO_X(1.0, false),
     MOVETO_Y(26.49 + 3.25, false),  // ↑3.5↑ Initial offset
 
@@ -187,7 +190,7 @@ Command RIGHT[] = {
     SPRAY_OFF(),           // ○ - Stop spray
 };
 
-Command LIP[] = {
+const PackedCommand LIP[] = {
     // Initial Movement
     MOVETO_X(1.0, false),       // Move to starting position
     MOVETO_Y(0 + 2.75, false),  // Initial Y offset
@@ -228,8 +231,23 @@ Command LIP[] = {
     SPRAY_OFF(),           // Stop spray
 };
 
-const int FRONT_SIZE = sizeof(FRONT) / sizeof(Command);
-const int BACK_SIZE = sizeof(BACK) / sizeof(Command);
-const int LEFT_SIZE = sizeof(LEFT) / sizeof(Command);
-const int RIGHT_SIZE = sizeof(RIGHT) / sizeof(Command);
-const int LIP_SIZE = sizeof(LIP) / sizeof(Command);
\ No newline at end of file
+const PackedCommand* const TABLES[] = {FRONT, BACK, LEFT, RIGHT, LIP};
+const int SIZES[] = {
+    sizeof(FRONT) / sizeof(PackedCommand), sizeof(BACK) / sizeof(PackedCommand),
+    sizeof(LEFT) / sizeof(PackedCommand), sizeof(RIGHT) / sizeof(PackedCommand),
+    sizeof(LIP) / sizeof(PackedCommand)};
+}  // namespace
+
+int builtInPatternSize(int side)
+{
+    return side >= 0 && side < 5 ? SIZES[side] : 0;
+}
+
+Command builtInPatternCommand(int side, int index)
+{
+    if (index < 0 || index >= builtInPatternSize(side))
+    {
+        return Command();
+    }
+    return TABLES[side][index].unpack();
+}
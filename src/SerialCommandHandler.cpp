@@ -51,7 +51,31 @@ void SerialCommandHandler::setup()
     Serial.println(F("  BACK_WASH_TIME <seconds> - Set back wash duration"));
     Serial.println(F("  SERVO <angle>    - Set servo angle (0-180)"));
     Serial.println(F("  SERVO_GET        - Get current servo angle"));
+    Serial.println(F("  QUEUE_STATUS     - Report motion queue statistics"));
+    Serial.println(
+        F("  ESTIMATE [side] - Job time from here, the full job by default"));
+    Serial.println(
+        F("  JUNCTION_DEVIATION <inches> - Corner blending (0 = off)"));
+    Serial.println(
+        F("  JERK <X|Y> <value> - S-curve jerk limit (0 = trapezoid)"));
+    Serial.println(
+        F("  RAPID <X|Y> <speed> <accel> - Spray-off traverse profile"));
+    Serial.println(F("  OVERRIDE <10-200> - Feed override percent, live"));
+    Serial.println(
+        F("  MAX_WIND <turns> - Table wind limit either way (0 = none)"));
+    Serial.println(F("  JOG <x> <y> - Streamed jog, speeds -1 to 1; JOG_HB "
+                     "keeps it alive"));
+    Serial.println(F("  SHAPER <X|Y> <NONE|ZV|ZVD> [hz] [damping] - Input "
+                     "shaping"));
     Serial.println(F("  SET_GRID <x> <y> - Set pattern grid dimensions"));
+    Serial.println(
+        F("  SET_RUN_UP <inches> - Pass overrun, spray on the area only"));
+    Serial.println(F("  PATTERNS <BUILTIN|GRID> - Paint from the fixed tables "
+                     "or the settings"));
+    Serial.println(
+        F("  VALVE_LATENCY <open_ms> <close_ms> - Paint valve lag to lead"));
+    Serial.println(F("  SPRAY_DUTY <min%> <max%> | OFF - Valve duty follows "
+                     "head speed"));
     Serial.println(
         F("  SET_HORIZONTAL_TRAVEL <x> <y> - Set horizontal travel distances"));
     Serial.println(
@@ -60,6 +84,8 @@ void SerialCommandHandler::setup()
         F("  SET_LIP_TRAVEL <x> <y> - Set lip pattern travel distances"));
     Serial.println(
         F("  SET_OFFSET <side> <x> <y> <angle> - Set offsets for side"));
+    Serial.println(F("  KEEP_OUT <xmin> <ymin> <xmax> <ymax> - Area to avoid "
+                     "while rotating (KEEP_OUT OFF to clear)"));
     Serial.println(F("  PRIME_TIME <seconds> - Set prime duration"));
     Serial.println(F("  CLEAN_TIME <seconds> - Set clean duration"));
 }
@@ -125,6 +151,13 @@ void SerialCommandHandler::processCommands()
         return;
     }
 
+    // Streamed jog packets and heartbeats
+    if (command.startsWith("JOG"))
+    {
+        handleJogCommand(command);
+        return;
+    }
+
     // Handle manual movement commands separately
     if (command.startsWith("MANUAL_MOVE_DIAGONAL "))
     {
@@ -303,18 +336,11 @@ void SerialCommandHandler::handleManualMovement(const String& command)
         Serial.print(F(" Y="));
         Serial.println(yPos);
 
-        // Create and execute movement commands
-        Command xMove('M', xPos, false);
-        Command yMove('N', yPos, false);
-
-        // Execute Y movement first to avoid potential collisions
-        if (movementController.executeCommand(yMove))
+        // Both axes travel one interpolated straight line
+        if (movementController.moveToPosition(xPos, yPos))
         {
-            if (movementController.executeCommand(xMove))
-            {
-                sendResponse(true, "Moving to position");
-                return;
-            }
+            sendResponse(true, "Moving to position");
+            return;
         }
 
         sendResponse(false, "Failed to initiate movement");
@@ -377,7 +403,20 @@ void SerialCommandHandler::handleSystemCommand(const String& command)
     if (command == "START" || command == "FRONT" || command == "BACK" ||
         command == "LEFT" || command == "RIGHT" || command == "LIP")
     {
-        if (currentState == HOMED)
+        int side = (command == "START")   ? -1
+                   : (command == "FRONT") ? 0
+                   : (command == "BACK")  ? 1
+                   : (command == "LEFT")  ? 2
+                   : (command == "RIGHT") ? 3
+                                          : 4;  // LIP pattern
+
+        if (currentState == HOMED && !patternExecutor.checkSoftLimits(side))
+        {
+            // Reject before the pressure pot is brought up
+            validCommand = false;
+            responseMsg = "Job would exceed the soft limits";
+        }
+        else if (currentState == HOMED)
         {
             // Check if pressure pot is active
             if (!maintenanceController.isPressurePotActive())
@@ -408,21 +447,27 @@ void SerialCommandHandler::handleSystemCommand(const String& command)
             // Process the command
             if (command == "START")
             {
-                patternExecutor.startPattern();
-                stateManager.setState(EXECUTING_PATTERN);
-                responseMsg = "Starting full pattern";
+                if (patternExecutor.startPattern())
+                {
+                    stateManager.setState(EXECUTING_PATTERN);
+                    responseMsg = "Starting full pattern";
+                }
+                else
+                {
+                    validCommand = false;
+                    responseMsg = "Pattern rejected, see status for details";
+                }
             }
-            else
+            else if (patternExecutor.startSingleSide(side))
             {
-                int side = (command == "FRONT")   ? 0
-                           : (command == "BACK")  ? 1
-                           : (command == "LEFT")  ? 2
-                           : (command == "RIGHT") ? 3
-                                                  : 4;  // LIP pattern
-                patternExecutor.startSingleSide(side);
                 stateManager.setState(PAINTING_SIDE);
                 responseMsg = "Starting single side pattern";
             }
+            else
+            {
+                validCommand = false;
+                responseMsg = "Side rejected, see status for details";
+            }
         }
         else
         {
@@ -572,6 +617,69 @@ void SerialCommandHandler::handleSystemCommand(const String& command)
             responseMsg = "Grid dimensions updated";
         }
     }
+    else if (command == "SPRAY_DUTY OFF")
+    {
+        movementController.setSprayDuty(false, SPRAY_DUTY_MIN_PERCENT,
+                                        SPRAY_DUTY_MAX_PERCENT);
+        responseMsg = "Spray duty fixed at full flow";
+    }
+    else if (command.startsWith("SPRAY_DUTY "))
+    {
+        // SPRAY_DUTY <min%> <max%>
+        int spaceIndex = command.indexOf(' ', 11);
+        float minPercent = command.substring(11, spaceIndex).toFloat();
+        float maxPercent = command.substring(spaceIndex + 1).toFloat();
+        if (spaceIndex != -1 && minPercent >= 0 && maxPercent <= 100 &&
+            minPercent <= maxPercent && maxPercent > 0)
+        {
+            movementController.setSprayDuty(true, minPercent, maxPercent);
+            snprintf(responseBuffer, sizeof(responseBuffer),
+                     "Spray duty follows head speed, %d-%d%%",
+                     static_cast<int>(minPercent),
+                     static_cast<int>(maxPercent));
+            responseMsg = responseBuffer;
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Usage: SPRAY_DUTY <min%> <max%> or SPRAY_DUTY OFF";
+        }
+    }
+    else if (command.startsWith("VALVE_LATENCY "))
+    {
+        int spaceIndex = command.indexOf(' ', 14);
+        float openMillis = command.substring(14, spaceIndex).toFloat();
+        float closeMillis = command.substring(spaceIndex + 1).toFloat();
+        if (spaceIndex != -1 && openMillis >= 0 && closeMillis >= 0)
+        {
+            movementController.setValveLatency(openMillis, closeMillis);
+            responseMsg = "Valve latency updated";
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Usage: VALVE_LATENCY <open_ms> <close_ms>";
+        }
+    }
+    else if (command.startsWith("SET_RUN_UP "))
+    {
+        float inches = command.substring(11).toFloat();
+        if (inches >= 0)
+        {
+            patternExecutor.setSprayRunUp(inches);
+            responseMsg = "Spray run-up updated";
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Run-up must not be negative";
+        }
+    }
+    else if (command == "PATTERNS BUILTIN" || command == "PATTERNS GRID")
+    {
+        patternExecutor.setBuiltInPatterns(command == "PATTERNS BUILTIN");
+        responseMsg = "Pattern source updated";
+    }
     else if (command.startsWith("SET_HORIZONTAL_TRAVEL "))
     {
         int spaceIndex = command.indexOf(
@@ -681,6 +789,43 @@ void SerialCommandHandler::handleSystemCommand(const String& command)
             responseMsg = "Invalid command format";
         }
     }
+    else if (command == "KEEP_OUT OFF")
+    {
+        patternExecutor.setRotationKeepOut(0, 0, 0, 0);
+        responseMsg = "Rotation keep-out cleared";
+    }
+    else if (command.startsWith("KEEP_OUT "))
+    {
+        // Format: KEEP_OUT <xmin> <ymin> <xmax> <ymax>
+        int firstSpace = command.indexOf(' ', 9);
+        int secondSpace = command.indexOf(' ', firstSpace + 1);
+        int thirdSpace = command.indexOf(' ', secondSpace + 1);
+
+        if (firstSpace != -1 && secondSpace != -1 && thirdSpace != -1)
+        {
+            float xMin = command.substring(9, firstSpace).toFloat();
+            float yMin =
+                command.substring(firstSpace + 1, secondSpace).toFloat();
+            float xMax =
+                command.substring(secondSpace + 1, thirdSpace).toFloat();
+            float yMax = command.substring(thirdSpace + 1).toFloat();
+            if (xMax > xMin && yMax > yMin)
+            {
+                patternExecutor.setRotationKeepOut(xMin, yMin, xMax, yMax);
+                responseMsg = "Rotation keep-out updated";
+            }
+            else
+            {
+                validCommand = false;
+                responseMsg = "Keep-out max must be greater than min";
+            }
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Usage: KEEP_OUT <xmin> <ymin> <xmax> <ymax>";
+        }
+    }
     else if (command.startsWith("SET_OFFSET "))
     {
         // Format: SET_OFFSET <side> <x> <y> <angle>
@@ -921,6 +1066,196 @@ void SerialCommandHandler::handleSystemCommand(const String& command)
         sendResponse(true, response);
         return;
     }
+    else if (command.startsWith("JUNCTION_DEVIATION "))
+    {
+        float inches = command.substring(command.indexOf(' ') + 1).toFloat();
+        if (inches >= 0 && inches <= 0.5)
+        {
+            movementController.setJunctionDeviation(inches);
+            responseMsg = inches > 0 ? "Corner blending updated"
+                                     : "Corner blending disabled";
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Junction deviation must be between 0 and 0.5 inches";
+        }
+    }
+    else if (command.startsWith("JERK "))
+    {
+        // JERK <X|Y> <steps/s^3>, 0 goes back to trapezoid ramps
+        int spaceIndex = command.indexOf(' ', 5);
+        String axis = command.substring(5, spaceIndex);
+        float jerk = spaceIndex != -1
+                         ? command.substring(spaceIndex + 1).toFloat()
+                         : -1;
+        if ((axis == "X" || axis == "Y") && jerk >= 0)
+        {
+            movementController.setJerk(axis == "X", jerk);
+            responseMsg = jerk > 0 ? "S-curve profile enabled"
+                                   : "Trapezoid profile enabled";
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Usage: JERK <X|Y> <steps/s^3>";
+        }
+    }
+    else if (command.startsWith("RAPID "))
+    {
+        // RAPID <X|Y> <steps/s> <steps/s^2>
+        int firstSpace = command.indexOf(' ', 6);
+        int secondSpace = command.indexOf(' ', firstSpace + 1);
+        String axis = command.substring(6, firstSpace);
+        float speed = 0;
+        float accel = 0;
+        if (firstSpace != -1 && secondSpace != -1)
+        {
+            speed = command.substring(firstSpace + 1, secondSpace).toFloat();
+            accel = command.substring(secondSpace + 1).toFloat();
+        }
+        if ((axis == "X" || axis == "Y") && speed > 0 && accel > 0)
+        {
+            movementController.setRapidProfile(axis == "X", speed, accel);
+            responseMsg = "Rapid traverse profile updated";
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Usage: RAPID <X|Y> <speed> <acceleration>";
+        }
+    }
+    else if (command.startsWith("OVERRIDE "))
+    {
+        float percent = command.substring(9).toFloat();
+        if (percent >= FEED_OVERRIDE_MIN_PERCENT &&
+            percent <= FEED_OVERRIDE_MAX_PERCENT)
+        {
+            movementController.setFeedOverride(percent);
+            snprintf(responseBuffer, sizeof(responseBuffer),
+                     "Feed override set to %d%%", static_cast<int>(percent));
+            responseMsg = responseBuffer;
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Feed override must be between 10 and 200 percent";
+        }
+    }
+    else if (command.startsWith("MAX_WIND "))
+    {
+        String value = command.substring(9);
+        value.trim();
+        int turns = value.toInt();
+        if (value.length() > 0 && turns >= 0)
+        {
+            movementController.setMaxWindTurns(turns);
+            snprintf(responseBuffer, sizeof(responseBuffer),
+                     "Rotation wind limit set to %d turns (now at turn %ld)",
+                     turns, movementController.getRotationTurns());
+            responseMsg = responseBuffer;
+        }
+        else
+        {
+            validCommand = false;
+            responseMsg = "Usage: MAX_WIND <turns> (0 = no limit)";
+        }
+    }
+    else if (command.startsWith("SHAPER "))
+    {
+        // SHAPER <X|Y> <NONE|ZV|ZVD> <hz> <damping>
+        int firstSpace = command.indexOf(' ', 7);
+        int secondSpace = command.indexOf(' ', firstSpace + 1);
+        int thirdSpace = command.indexOf(' ', secondSpace + 1);
+        String axis = command.substring(7, firstSpace);
+        String type = firstSpace != -1
+                          ? command.substring(firstSpace + 1, secondSpace)
+                          : "";
+        float frequency = 0;
+        float damping = 0;
+        if (secondSpace != -1 && thirdSpace != -1)
+        {
+            frequency =
+                command.substring(secondSpace + 1, thirdSpace).toFloat();
+            damping = command.substring(thirdSpace + 1).toFloat();
+        }
+
+        bool typeValid = type == "NONE" || type == "ZV" || type == "ZVD";
+        InputShaper::Type shaperType = type == "ZV"    ? InputShaper::ZV
+                                       : type == "ZVD" ? InputShaper::ZVD
+                                                       : InputShaper::NONE;
+        if ((axis != "X" && axis != "Y") || !typeValid)
+        {
+            validCommand = false;
+            responseMsg = "Usage: SHAPER <X|Y> <NONE|ZV|ZVD> <hz> <damping>";
+        }
+        else if (movementController.isMoving())
+        {
+            validCommand = false;
+            responseMsg = "Cannot change input shaping while moving";
+        }
+        else if (!movementController.setInputShaper(axis == "X", shaperType,
+                                                    frequency, damping))
+        {
+            validCommand = false;
+            responseMsg = "Shaper frequency or damping out of range";
+        }
+        else
+        {
+            responseMsg = shaperType == InputShaper::NONE
+                              ? "Input shaping disabled"
+                              : "Input shaping updated";
+        }
+    }
+    else if (command == "ESTIMATE" || command.startsWith("ESTIMATE "))
+    {
+        // ESTIMATE [FRONT|BACK|LEFT|RIGHT|LIP], the full job by default
+        String sideName = command.length() > 9 ? command.substring(9) : "";
+        int side = (sideName == "") ? -1
+                   : (sideName == "FRONT") ? 0
+                   : (sideName == "BACK")  ? 1
+                   : (sideName == "LEFT")  ? 2
+                   : (sideName == "RIGHT") ? 3
+                   : (sideName == "LIP")   ? 4
+                                           : -2;
+        if (side == -2)
+        {
+            validCommand = false;
+            responseMsg = "Usage: ESTIMATE [FRONT|BACK|LEFT|RIGHT|LIP]";
+        }
+        else
+        {
+            // Starting also waits out the rest of the pressure pot delay
+            unsigned long potDelay =
+                maintenanceController.getPressurePotDelay();
+            unsigned long potMillis = potDelay;
+            if (maintenanceController.isPressurePotActive())
+            {
+                unsigned long active =
+                    maintenanceController.getPressurePotActiveTime();
+                potMillis = active < potDelay ? potDelay - active : 0;
+            }
+            unsigned long motionMillis =
+                lroundf(patternExecutor.estimateJobSeconds(side) * 1000);
+            snprintf(responseBuffer, sizeof(responseBuffer),
+                     "Estimate: total_ms=%lu motion_ms=%lu pressure_ms=%lu",
+                     motionMillis + potMillis, motionMillis, potMillis);
+            responseMsg = responseBuffer;
+        }
+    }
+    else if (command == "QUEUE_STATUS")
+    {
+        char response[96];
+        snprintf(response, sizeof(response),
+                 "Queue: depth=%d/%d high=%d starved=%lu (%lums)",
+                 movementController.getQueueDepth(),
+                 movementController.getQueueCapacity(),
+                 movementController.getQueueHighWater(),
+                 movementController.getStarvationCount(),
+                 movementController.getStarvedMillis());
+        sendResponse(true, response);
+        return;
+    }
     else
     {
         validCommand = false;
@@ -1042,6 +1377,53 @@ void SerialCommandHandler::handleContinuousMovement(const String& command)
     }
 }
 
+void SerialCommandHandler::handleJogCommand(const String& command)
+{
+    // Heartbeats only keep a running jog alive
+    if (command == "JOG_HB")
+    {
+        movementController.jogHeartbeat();
+        return;
+    }
+
+    // Parse command: JOG <x> <y>, signed fractions of the axis speeds
+    int firstSpace = command.indexOf(' ');
+    int secondSpace = command.indexOf(' ', firstSpace + 1);
+    if (firstSpace == -1 || secondSpace == -1)
+    {
+        sendResponse(false, "Invalid jog command format");
+        return;
+    }
+
+    SystemState currentState = stateManager.getCurrentState();
+    bool jogging = movementController.isJogging();
+    if (!jogging && currentState != IDLE && currentState != HOMED)
+    {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer),
+                 "Can only jog from IDLE or HOMED state (current: %s)",
+                 getStateString(currentState));
+        sendResponse(false, buffer);
+        return;
+    }
+
+    float x = command.substring(firstSpace + 1, secondSpace).toFloat();
+    float y = command.substring(secondSpace + 1).toFloat();
+    if (!movementController.jog(x, y))
+    {
+        sendResponse(false, "Failed to start jog");
+        return;
+    }
+
+    // Only the packet that starts a jog is answered, so a pendant streaming
+    // packets does not fill the link with replies
+    if (!jogging && movementController.isJogging())
+    {
+        stateManager.setState(EXECUTING_MANUAL_MOVE);
+        sendResponse(true, "Jog started");
+    }
+}
+
 void SerialCommandHandler::handleManualStop()
 {
     movementController.stopMovement();
@@ -35,7 +35,7 @@ bool ServoController::setAngle(int angle)
     currentAngle = angle;
     servo.write(angle);
     Serial.println(F("Servo angle updated successfully"));
-    delay(15);  // Allow servo to move
+    delay(SERVO_SETTLE_MS);  // Allow servo to move
 
     return true;
 }
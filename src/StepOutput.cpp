@@ -0,0 +1,30 @@
+// StepOutput.cpp
+#include "StepOutput.h"
+
+StepOutput::StepOutput(uint8_t pin)
+    : pin(pin), setRegister(nullptr), resetRegister(nullptr), mask(0)
+{
+    pinMode(pin, OUTPUT);
+
+#ifndef STEP_TIMER_SIMULATED
+    // The board pin maps to an RA4M1 port and bit; the port register blocks
+    // are laid out at a fixed stride from PORT0
+    bsp_io_port_pin_t bspPin = digitalPinToBspPin(pin);
+    uint32_t port = static_cast<uint32_t>(bspPin) >> 8;
+    uint32_t stride = R_PORT1_BASE - R_PORT0_BASE;
+    R_PORT0_Type* block =
+        reinterpret_cast<R_PORT0_Type*>(R_PORT0_BASE + port * stride);
+    setRegister = &block->POSR;
+    resetRegister = &block->PORR;
+    mask = static_cast<uint16_t>(1U << (static_cast<uint32_t>(bspPin) & 0xFF));
+#endif
+
+    clear();
+}
+
+StepOutput::StepOutput(volatile uint16_t* setRegister,
+                       volatile uint16_t* resetRegister, uint16_t mask)
+    : pin(0), setRegister(setRegister), resetRegister(resetRegister), mask(mask)
+{
+    clear();
+}
@@ -0,0 +1,140 @@
+// StepTimer.cpp
+#include "StepTimer.h"
+
+StepTimer* StepTimer::instance = nullptr;
+
+StepTimer::StepTimer()
+    : callback(nullptr),
+      frequency(1),
+      running(false),
+      tickCount(0)
+#ifdef STEP_TIMER_SIMULATED
+      ,
+      pendingMicros(0)
+#endif
+{
+}
+
+void StepTimer::fire()
+{
+    tickCount++;
+    if (callback)
+    {
+        callback();
+    }
+}
+
+#ifdef STEP_TIMER_SIMULATED
+
+bool StepTimer::begin(unsigned long frequencyHz, Callback cb)
+{
+    if (frequencyHz == 0 || cb == nullptr)
+    {
+        return false;
+    }
+
+    callback = cb;
+    frequency = frequencyHz;
+    pendingMicros = 0;
+    instance = this;
+    running = true;
+    return true;
+}
+
+void StepTimer::end()
+{
+    running = false;
+    if (instance == this)
+    {
+        instance = nullptr;
+    }
+}
+
+void StepTimer::tick()
+{
+    if (running)
+    {
+        fire();
+    }
+}
+
+void StepTimer::advance(unsigned long elapsedMicros)
+{
+    if (!running)
+    {
+        return;
+    }
+
+    pendingMicros += elapsedMicros;
+    unsigned long period = getPeriodMicros();
+    while (pendingMicros >= period)
+    {
+        pendingMicros -= period;
+        fire();
+    }
+}
+
+#else
+
+void StepTimer::isr(timer_callback_args_t* args)
+{
+    (void)args;
+    if (instance)
+    {
+        instance->fire();
+    }
+}
+
+bool StepTimer::begin(unsigned long frequencyHz, Callback cb)
+{
+    if (frequencyHz == 0 || cb == nullptr)
+    {
+        return false;
+    }
+
+    callback = cb;
+    frequency = frequencyHz;
+    instance = this;
+
+    // Prefer a free GPT channel, fall back to the ones reserved for PWM
+    uint8_t timerType = GPT_TIMER;
+    int8_t channel = FspTimer::get_available_timer(timerType);
+    if (channel < 0)
+    {
+        FspTimer::force_use_of_pwm_reserved_timer();
+        channel = FspTimer::get_available_timer(timerType, true);
+    }
+    if (channel < 0)
+    {
+        return false;
+    }
+
+    if (!timer.begin(TIMER_MODE_PERIODIC, timerType, channel,
+                     static_cast<float>(frequencyHz), 0.0f, isr))
+    {
+        return false;
+    }
+    if (!timer.setup_overflow_irq() || !timer.open() || !timer.start())
+    {
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void StepTimer::end()
+{
+    if (running)
+    {
+        timer.stop();
+        timer.close();
+    }
+    running = false;
+    if (instance == this)
+    {
+        instance = nullptr;
+    }
+}
+
+#endif
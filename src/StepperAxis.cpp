@@ -0,0 +1,337 @@
+// StepperAxis.cpp
+#include "StepperAxis.h"
+
+#include <math.h>
+
+#include "config.h"
+
+const float STEP_FIXED_ONE = 4294967296.0f;  // One step per tick
+const float STEP_FIXED_MAX = 4294967040.0f;  // Largest float below that
+
+// Longest wait spent busy inside the step interrupt, per axis and wait.
+// Anything longer spans ticks instead, so three axes can never hold the
+// interrupt for more than a few microseconds.
+const unsigned int INLINE_MAX_MICROS = 2;
+
+// Whole step timer ticks covering a driver time, at least one
+static uint8_t ticksCovering(unsigned int micros)
+{
+    unsigned long ticks =
+        (micros * STEP_TIMER_FREQUENCY_HZ + 999999UL) / 1000000UL;
+    return constrain(ticks, 1UL, 255UL);
+}
+
+StepperAxis::StepperAxis(uint8_t stepPin, uint8_t dirPin)
+    : stepOutput(stepPin),
+      dirOutput(dirPin),
+      invertDirection(false),
+      pulseMicros(0),
+      setupMicros(0),
+      pulseEnded(false),
+      maxSpeedSteps(0),
+      accelerationSteps(0),
+      maxSpeedFixed(0),
+      accelerationFixed(0),
+      minimumSpeedFixed(0),
+      position(0),
+      target(0),
+      speed(0),
+      phase(0),
+      rampSteps(0),
+      forward(true),
+      pinForward(true),
+      pulseTicks(1),
+      pulseTicksLeft(0),
+      setupTicks(0),
+      setupTicksLeft(0),
+      holdTicks(1),
+      holdTicksLeft(0),
+      shaper(nullptr),
+      motorPosition(0)
+{
+    setDirection(true);
+    setDriverTiming(INLINE_MAX_MICROS, INLINE_MAX_MICROS, INLINE_MAX_MICROS);
+    setMaxSpeed(1);
+    setAcceleration(1);
+}
+
+void StepperAxis::setMaxSpeed(float stepsPerSecond)
+{
+    maxSpeedSteps = fabsf(stepsPerSecond);
+
+    // Pulses spanning ticks need at least one low tick between them
+    float limit =
+        pulseTicks == 0 ? STEP_FIXED_MAX : STEP_FIXED_ONE / (pulseTicks + 1);
+    float fixed = maxSpeedSteps / STEP_TIMER_FREQUENCY_HZ * STEP_FIXED_ONE;
+    maxSpeedFixed = static_cast<uint32_t>(fixed < limit ? fixed : limit);
+}
+
+void StepperAxis::setAcceleration(float stepsPerSecondSquared)
+{
+    if (stepsPerSecondSquared == 0)
+    {
+        return;  // The axis would never get moving
+    }
+    accelerationSteps = fabsf(stepsPerSecondSquared);
+
+    float perTick = accelerationSteps / STEP_TIMER_FREQUENCY_HZ /
+                    STEP_TIMER_FREQUENCY_HZ * STEP_FIXED_ONE;
+    perTick = constrain(perTick, 1.0f, STEP_FIXED_MAX);
+    accelerationFixed = static_cast<uint32_t>(perTick);
+
+    // Speed after the first step from rest, used to creep in on the target
+    minimumSpeedFixed = static_cast<uint32_t>(
+        sqrtf(accelerationSteps * 0.5f) / STEP_TIMER_FREQUENCY_HZ *
+        STEP_FIXED_ONE);
+}
+
+void StepperAxis::setPinsInverted(bool directionInvert)
+{
+    invertDirection = directionInvert;
+    setDirection(pinForward);
+}
+
+void StepperAxis::setDriverTiming(unsigned int pulseWidth,
+                                  unsigned int dirSetup, unsigned int dirHold)
+{
+    // Short pulses are timed inside the interrupt, longer ones span ticks
+    if (pulseWidth <= INLINE_MAX_MICROS)
+    {
+        pulseMicros = pulseWidth;
+        pulseTicks = 0;
+    }
+    else
+    {
+        pulseMicros = 0;
+        pulseTicks = ticksCovering(pulseWidth);
+    }
+
+    // The direction only changes a whole number of ticks after the last
+    // pulse ended. A setup too long to wait out inline puts the step off by
+    // whole ticks too.
+    holdTicks = ticksCovering(dirHold);
+    if (dirSetup <= INLINE_MAX_MICROS)
+    {
+        setupMicros = dirSetup;
+        setupTicks = 0;
+    }
+    else
+    {
+        setupMicros = 0;
+        setupTicks = ticksCovering(dirSetup);
+    }
+    setMaxSpeed(maxSpeedSteps);
+}
+
+void StepperAxis::attachShaper(InputShaper* inputShaper)
+{
+    shaper = inputShaper;
+    motorPosition = position;
+    if (shaper)
+    {
+        shaper->reset(position);
+    }
+}
+
+bool StepperAxis::isRunning() const
+{
+    if (speed != 0 || position != target || motorPosition != position)
+    {
+        return true;
+    }
+    return shaper && !shaper->isSettled();
+}
+
+float StepperAxis::maxStepRate() const
+{
+    return static_cast<float>(STEP_TIMER_FREQUENCY_HZ) / (pulseTicks + 1);
+}
+
+void StepperAxis::moveTo(long absolute) { target = absolute; }
+
+void StepperAxis::stop()
+{
+    if (speed == 0)
+    {
+        target = position;
+        return;
+    }
+    target = position + (forward ? rampSteps + 1 : -(rampSteps + 1));
+}
+
+void StepperAxis::setCurrentPosition(long newPosition)
+{
+    position = newPosition;
+    target = newPosition;
+    speed = 0;
+    phase = 0;
+    rampSteps = 0;
+
+    // The motor is taken to be here now, whatever shaping was still owed
+    motorPosition = newPosition;
+    if (shaper)
+    {
+        shaper->reset(newPosition);
+    }
+}
+
+void StepperAxis::stepOnce(bool forwardStep)
+{
+    advance(forwardStep);
+    target = position;
+}
+
+void StepperAxis::tick()
+{
+    pulseEnded = false;
+    if (holdTicksLeft > 0)
+    {
+        holdTicksLeft--;
+    }
+    if (setupTicksLeft > 0)
+    {
+        setupTicksLeft--;
+    }
+
+    // Finish a pulse started on an earlier tick
+    if (pulseTicksLeft > 0 && --pulseTicksLeft == 0)
+    {
+        stepOutput.clear();
+        pulseEnded = true;
+        holdTicksLeft = holdTicks;
+    }
+
+    // Follow the shaped command, or catch up on a step that was put off
+    followCommand(shaper ? shaper->update(position) : position);
+
+    long toGo = target - position;
+    if (speed == 0)
+    {
+        if (toGo == 0)
+        {
+            return;
+        }
+        forward = toGo > 0;
+        rampSteps = 0;
+    }
+
+    // Brake when heading away from the target, when above a lowered speed
+    // limit, or once the steps left are no more than it took to get up to
+    // speed. Approaching the target never drops below the creep speed.
+    bool wrongWay = toGo == 0 || (toGo > 0) != forward;
+    long stepsLeft = toGo < 0 ? -toGo : toGo;
+    bool accelerating = false;
+    bool braking = wrongWay || stepsLeft <= rampSteps || speed > maxSpeedFixed;
+    if (braking)
+    {
+        uint32_t slowest = 0;
+        if (!wrongWay)
+        {
+            slowest = minimumSpeedFixed < maxSpeedFixed ? minimumSpeedFixed
+                                                        : maxSpeedFixed;
+            if (speed > maxSpeedFixed)
+            {
+                slowest = maxSpeedFixed;
+            }
+        }
+        speed = speed > slowest + accelerationFixed ? speed - accelerationFixed
+                                                    : slowest;
+        if (speed == 0)
+        {
+            phase = 0;
+            return;  // Turn around on the next tick
+        }
+    }
+    else if (speed < maxSpeedFixed)
+    {
+        speed += accelerationFixed;
+        if (speed > maxSpeedFixed)
+        {
+            speed = maxSpeedFixed;
+        }
+        accelerating = true;
+    }
+
+    uint32_t previous = phase;
+    phase += speed;
+    if (phase >= previous)
+    {
+        return;  // No carry, no step this tick
+    }
+
+    advance(forward);
+    if (accelerating)
+    {
+        rampSteps++;
+    }
+    else if (braking && rampSteps > 0)
+    {
+        rampSteps--;
+    }
+
+    if (position == target)
+    {
+        speed = 0;
+        phase = 0;
+        rampSteps = 0;
+    }
+}
+
+void StepperAxis::advance(bool forwardStep)
+{
+    position += forwardStep ? 1 : -1;
+    if (!shaper)
+    {
+        followCommand(position);
+    }
+}
+
+void StepperAxis::followCommand(long commanded)
+{
+    // One motor step per tick at most. A pulse that is still high, or that
+    // ended this tick, needs its low time first, and a direction change its
+    // setup time.
+    if (commanded == motorPosition || pulseTicksLeft > 0 || pulseEnded ||
+        setupTicksLeft > 0)
+    {
+        return;
+    }
+
+    bool forwardStep = commanded > motorPosition;
+    if (forwardStep != pinForward)
+    {
+        if (holdTicksLeft > 0)
+        {
+            return;  // The last pulse's hold time is not up yet
+        }
+        setDirection(forwardStep);
+        if (setupTicks > 0)
+        {
+            setupTicksLeft = setupTicks;
+            return;  // Step once the setup time is up
+        }
+        delayMicroseconds(setupMicros);
+    }
+    pulse();
+    motorPosition += forwardStep ? 1 : -1;
+}
+
+void StepperAxis::setDirection(bool forwardStep)
+{
+    pinForward = forwardStep;
+    dirOutput.write(forwardStep != invertDirection);
+}
+
+void StepperAxis::pulse()
+{
+    stepOutput.set();
+    if (pulseTicks == 0)
+    {
+        delayMicroseconds(pulseMicros);
+        stepOutput.clear();
+        pulseEnded = true;
+        holdTicksLeft = holdTicks;
+        return;
+    }
+    pulseTicksLeft = pulseTicks;
+}
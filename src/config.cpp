@@ -8,5 +8,11 @@ int ROTATION_SPEED = 350;  // Steps per second
 int X_ACCEL = 5000;        // Steps per second per second
 int Y_ACCEL = 2500;        // Steps per second per second
 int ROTATION_ACCEL = 75;   // Steps per second per second
+int X_JERK = 0;            // Steps per second cubed (S-curve when non-zero)
+int Y_JERK = 0;            // Steps per second cubed (S-curve when non-zero)
+int X_RAPID_SPEED = 1000;  // Steps per second, spray off
+int Y_RAPID_SPEED = 750;   // Steps per second, spray off
+int X_RAPID_ACCEL = 5000;  // Steps per second per second, spray off
+int Y_RAPID_ACCEL = 2500;  // Steps per second per second, spray off
 int HOMING_SPEED = 500;    // Steps per seconds
 int ROTATION_HOMING_SPEED = 350;
\ No newline at end of file
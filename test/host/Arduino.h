@@ -0,0 +1,67 @@
+// Arduino.h
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino core to build the motion sources on the host
+// (env:native). Time only moves when a test advances hostMicros, and every
+// pin write is kept in hostPins so tests can check the outputs.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define F(text) (text)
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) \
+    ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+const int HOST_PIN_COUNT = 64;
+
+inline unsigned long hostMicros = 0;
+inline int hostPins[HOST_PIN_COUNT];
+inline unsigned long hostPinWrites = 0;
+
+inline unsigned long micros() { return hostMicros; }
+inline unsigned long millis() { return hostMicros / 1000; }
+inline void delayMicroseconds(unsigned int us) { hostMicros += us; }
+inline void delay(unsigned long ms) { hostMicros += ms * 1000; }
+
+inline void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t value)
+{
+    hostPins[pin % HOST_PIN_COUNT] = value;
+    hostPinWrites++;
+}
+
+inline int digitalRead(uint8_t pin) { return hostPins[pin % HOST_PIN_COUNT]; }
+
+inline void analogWrite(uint8_t pin, int value)
+{
+    hostPins[pin % HOST_PIN_COUNT] = value;
+}
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+#endif
@@ -0,0 +1,153 @@
+// test_main.cpp
+// Host tests for the ZV/ZVD input shapers: the impulses must sum to the
+// command, and a resonance at the tuned frequency must be left still
+#include <unity.h>
+
+#include "InputShaper.h"
+#include "config.h"
+
+namespace
+{
+const float TICK_SECONDS = 1.0f / STEP_TIMER_FREQUENCY_HZ;
+const long STEP_SIZE = 100000;  // Large, so rounding to steps is negligible
+
+// Peak residual swing of a lightly damped resonance, driven through its
+// base by a command that jumps by STEP_SIZE, once the shaper has finished
+// and relative to the size of the jump
+float residualVibration(InputShaper* shaper, float resonanceHz,
+                        float damping)
+{
+    float omega = 2.0f * PI * resonanceHz;
+    double x = 0;  // Load position, steps
+    double v = 0;
+    float peak = 0;
+    long settleTicks = STEP_TIMER_FREQUENCY_HZ / 5;  // ZVD at 10 Hz: 0.1 s
+    long totalTicks = settleTicks + STEP_TIMER_FREQUENCY_HZ / 2;
+    for (long tick = 0; tick < totalTicks; tick++)
+    {
+        long base = shaper ? shaper->update(STEP_SIZE) : STEP_SIZE;
+        double accel = omega * omega * (base - x) - 2 * damping * omega * v;
+        v += accel * TICK_SECONDS;
+        x += v * TICK_SECONDS;
+        if (tick >= settleTicks && fabs(x - STEP_SIZE) > peak)
+        {
+            peak = fabs(x - STEP_SIZE);
+        }
+    }
+    return peak / STEP_SIZE;
+}
+
+// Shaped position a given number of ticks after the command jumps
+long shapedAfter(InputShaper& shaper, long ticks)
+{
+    shaper.reset(0);
+    long shaped = 0;
+    for (long i = 0; i <= ticks; i++)
+    {
+        shaped = shaper.update(STEP_SIZE);
+    }
+    return shaped;
+}
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_configure_rejects_unusable_settings()
+{
+    InputShaper shaper;
+    TEST_ASSERT_FALSE(shaper.configure(InputShaper::ZV, 0, 0.05f));
+    TEST_ASSERT_FALSE(shaper.configure(InputShaper::ZV, 10, 1.0f));
+    TEST_ASSERT_FALSE(shaper.configure(InputShaper::ZV, 2000, 0));  // Too fast
+    TEST_ASSERT_FALSE(shaper.configure(InputShaper::ZVD, 1, 0));  // Too slow
+    TEST_ASSERT_FALSE(shaper.isEnabled());
+    TEST_ASSERT_TRUE(shaper.configure(InputShaper::ZVD, 10, 0.1f));
+    TEST_ASSERT_TRUE(shaper.isEnabled());
+}
+
+void test_zv_impulses_sum_to_the_command()
+{
+    // Undamped, ZV is two equal impulses half a period (50 ms) apart
+    InputShaper shaper;
+    TEST_ASSERT_TRUE(shaper.configure(InputShaper::ZV, 10, 0));
+    TEST_ASSERT_EQUAL(STEP_SIZE / 2, shapedAfter(shaper, 100));
+    TEST_ASSERT_EQUAL(STEP_SIZE / 2, shapedAfter(shaper, 490));
+    TEST_ASSERT_EQUAL(STEP_SIZE, shapedAfter(shaper, 510));
+    TEST_ASSERT_EQUAL(STEP_SIZE, shapedAfter(shaper, 2000));
+}
+
+void test_zvd_impulses_sum_to_the_command()
+{
+    // Undamped, ZVD weighs its three impulses 1:2:1
+    InputShaper shaper;
+    TEST_ASSERT_TRUE(shaper.configure(InputShaper::ZVD, 10, 0));
+    TEST_ASSERT_EQUAL(STEP_SIZE / 4, shapedAfter(shaper, 490));
+    TEST_ASSERT_EQUAL(STEP_SIZE * 3 / 4, shapedAfter(shaper, 990));
+    TEST_ASSERT_EQUAL(STEP_SIZE, shapedAfter(shaper, 1010));
+}
+
+void test_damped_impulses_still_sum_to_the_command()
+{
+    InputShaper zv;
+    InputShaper zvd;
+    TEST_ASSERT_TRUE(zv.configure(InputShaper::ZV, 12, 0.2f));
+    TEST_ASSERT_TRUE(zvd.configure(InputShaper::ZVD, 12, 0.2f));
+    TEST_ASSERT_EQUAL(STEP_SIZE, shapedAfter(zv, 2000));
+    TEST_ASSERT_EQUAL(STEP_SIZE, shapedAfter(zvd, 2000));
+
+    // With damping the first impulse carries more than half
+    TEST_ASSERT_GREATER_THAN(STEP_SIZE / 2, shapedAfter(zv, 100));
+}
+
+void test_shapers_cancel_the_tuned_resonance()
+{
+    const float HZ = 10;
+    const float DAMPING = 0.05f;
+    float unshaped = residualVibration(nullptr, HZ, DAMPING);
+    TEST_ASSERT_GREATER_THAN(0.3f, unshaped);  // Rings without shaping
+
+    InputShaper zv;
+    TEST_ASSERT_TRUE(zv.configure(InputShaper::ZV, HZ, DAMPING));
+    zv.reset(0);
+    TEST_ASSERT_LESS_THAN(unshaped * 0.05f,
+                          residualVibration(&zv, HZ, DAMPING));
+
+    InputShaper zvd;
+    TEST_ASSERT_TRUE(zvd.configure(InputShaper::ZVD, HZ, DAMPING));
+    zvd.reset(0);
+    TEST_ASSERT_LESS_THAN(unshaped * 0.05f,
+                          residualVibration(&zvd, HZ, DAMPING));
+}
+
+void test_zvd_tolerates_a_mistuned_resonance()
+{
+    // Tuned 15% off the real frequency, ZVD should still leave less than
+    // ZV does
+    const float REAL_HZ = 10;
+    const float DAMPING = 0.05f;
+    InputShaper zv;
+    InputShaper zvd;
+    TEST_ASSERT_TRUE(zv.configure(InputShaper::ZV, REAL_HZ * 1.15f, DAMPING));
+    TEST_ASSERT_TRUE(zvd.configure(InputShaper::ZVD, REAL_HZ * 1.15f, DAMPING));
+    zv.reset(0);
+    zvd.reset(0);
+
+    float zvResidual = residualVibration(&zv, REAL_HZ, DAMPING);
+    float zvdResidual = residualVibration(&zvd, REAL_HZ, DAMPING);
+    float unshaped = residualVibration(nullptr, REAL_HZ, DAMPING);
+    TEST_ASSERT_LESS_THAN(zvResidual, zvdResidual);
+    TEST_ASSERT_LESS_THAN(unshaped * 0.1f, zvdResidual);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_configure_rejects_unusable_settings);
+    RUN_TEST(test_zv_impulses_sum_to_the_command);
+    RUN_TEST(test_zvd_impulses_sum_to_the_command);
+    RUN_TEST(test_damped_impulses_still_sum_to_the_command);
+    RUN_TEST(test_shapers_cancel_the_tuned_resonance);
+    RUN_TEST(test_zvd_tolerates_a_mistuned_resonance);
+    return UNITY_END();
+}
@@ -0,0 +1,480 @@
+// test_main.cpp
+// Host tests for the interpolator, and a per-step cost benchmark of the step
+// interrupt's path against AccelStepper's
+#include <stdio.h>
+#include <unity.h>
+
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Interpolator.h"
+
+namespace
+{
+const unsigned long TICK_HZ = 10000;
+
+// The interpolator's tick() as it was before the fixed-point rate: a
+// trapezoid profile and step accumulator kept in floats, stepping the same
+// axes through the same Bresenham loop
+struct FloatTick
+{
+    StepperAxis* axes[2];
+    long deltas[2];
+    long error[2];
+    float rate;
+    float cruiseRate;
+    float floorRate;
+    float accelPerTick;
+    float tickSeconds;
+    float stepFraction;
+    long stepsDone;
+    long decelerateAfter;
+    long endStep;
+
+    void begin(long steps, float cruise, float accel, float floor)
+    {
+        deltas[0] = steps;
+        deltas[1] = 0;
+        error[0] = steps / 2;
+        error[1] = steps / 2;
+        tickSeconds = 1.0f / TICK_HZ;
+        rate = floor;
+        cruiseRate = cruise;
+        floorRate = floor;
+        accelPerTick = accel * tickSeconds;
+        stepFraction = 0;
+        stepsDone = 0;
+        float rampSteps = (cruise * cruise - floor * floor) / (2.0f * accel);
+        decelerateAfter = steps - static_cast<long>(rampSteps + 1.0f);
+        endStep = steps;
+    }
+
+    bool tick()
+    {
+        if (stepsDone >= decelerateAfter)
+        {
+            rate -= accelPerTick;
+            if (rate < floorRate)
+            {
+                rate = floorRate;
+            }
+        }
+        else if (rate < cruiseRate)
+        {
+            rate += accelPerTick;
+            if (rate > cruiseRate)
+            {
+                rate = cruiseRate;
+            }
+        }
+
+        stepFraction += rate * tickSeconds;
+        if (stepFraction >= 1.0f)
+        {
+            stepFraction -= 1.0f;
+            stepsDone++;
+            for (int i = 0; i < 2; i++)
+            {
+                error[i] += deltas[i];
+                if (error[i] >= endStep)
+                {
+                    error[i] -= endStep;
+                    axes[i]->stepOnce(true);
+                }
+            }
+        }
+        return stepsDone < endStep;
+    }
+};
+
+// AccelStepper 1.64's run(): runSpeed() polls micros() and steps once the
+// interval is up, then computeNewSpeed() works out the next interval with
+// David Austin's recurrence. Same expressions, double literals included, with
+// the pin writes of its DRIVER mode.
+struct AccelStepperLoop
+{
+    long currentPos;
+    long targetPos;
+    float speed;
+    float maxSpeed;
+    float acceleration;
+    unsigned long stepInterval;
+    unsigned long lastStepTime;
+    long n;
+    float c0;
+    float cn;
+    float cmin;
+    bool clockwise;
+
+    void begin(long target, float maxSpeedSteps, float accel)
+    {
+        currentPos = 0;
+        targetPos = target;
+        speed = 0;
+        maxSpeed = maxSpeedSteps;
+        acceleration = accel;
+        stepInterval = 0;
+        lastStepTime = 0;
+        n = 0;
+        c0 = 0.676 * sqrt(2.0 / accel) * 1000000.0;
+        cn = 0;
+        cmin = 1000000.0 / maxSpeedSteps;
+        clockwise = true;
+        computeNewSpeed();
+    }
+
+    bool runSpeed()
+    {
+        if (!stepInterval)
+        {
+            return false;
+        }
+        unsigned long time = micros();
+        if (time - lastStepTime >= stepInterval)
+        {
+            currentPos += clockwise ? 1 : -1;
+            digitalWrite(3, clockwise ? HIGH : LOW);
+            digitalWrite(2, HIGH);
+            delayMicroseconds(1);
+            digitalWrite(2, LOW);
+            lastStepTime = time;
+            return true;
+        }
+        return false;
+    }
+
+    void computeNewSpeed()
+    {
+        long distanceTo = targetPos - currentPos;
+        long stepsToStop = (long)((speed * speed) / (2.0 * acceleration));
+        if (distanceTo == 0 && stepsToStop <= 1)
+        {
+            stepInterval = 0;
+            speed = 0.0;
+            n = 0;
+            return;
+        }
+        if (distanceTo > 0)
+        {
+            if (n > 0)
+            {
+                if ((stepsToStop >= distanceTo) || !clockwise)
+                {
+                    n = -stepsToStop;
+                }
+            }
+            else if (n < 0)
+            {
+                if ((stepsToStop < distanceTo) && clockwise)
+                {
+                    n = -n;
+                }
+            }
+        }
+        else if (distanceTo < 0)
+        {
+            if (n > 0)
+            {
+                if ((stepsToStop >= -distanceTo) || clockwise)
+                {
+                    n = -stepsToStop;
+                }
+            }
+            else if (n < 0)
+            {
+                if ((stepsToStop < -distanceTo) && !clockwise)
+                {
+                    n = -n;
+                }
+            }
+        }
+        if (n == 0)
+        {
+            cn = c0;
+            clockwise = distanceTo > 0;
+        }
+        else
+        {
+            cn = cn - ((2.0 * cn) / ((4.0 * n) + 1));
+            cn = max(cn, cmin);
+        }
+        n++;
+        stepInterval = cn;
+        speed = 1000000.0 / cn;
+        if (!clockwise)
+        {
+            speed = -speed;
+        }
+    }
+
+    bool run()
+    {
+        if (runSpeed())
+        {
+            computeNewSpeed();
+        }
+        return speed != 0.0 || targetPos != currentPos;
+    }
+};
+
+// Elapsed time stamp in cycles where the host has a cycle counter, else in
+// nanoseconds
+unsigned long long cycleStamp()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+StepperAxis* xAxis = nullptr;
+StepperAxis* yAxis = nullptr;
+Interpolator* interpolator = nullptr;
+
+const float RATES[2] = {1000, 750};
+const float ACCELS[2] = {5000, 2500};
+
+long runMove(long x, long y, const float* jerks = nullptr)
+{
+    long targets[2] = {xAxis->currentPosition() + x,
+                       yAxis->currentPosition() + y};
+    if (!interpolator->begin(targets, RATES, ACCELS, jerks))
+    {
+        return 0;  // Leaves the axes short of the target
+    }
+    long ticks = 0;
+    while (interpolator->isActive())
+    {
+        interpolator->tick();
+        ticks++;
+    }
+    return ticks;
+}
+
+}  // namespace
+
+void setUp()
+{
+    xAxis = new StepperAxis(2, 3);
+    yAxis = new StepperAxis(4, 5);
+    xAxis->setDriverTiming(0, 0, 0);  // Keep the shim clock still
+    yAxis->setDriverTiming(0, 0, 0);
+    interpolator = new Interpolator(TICK_HZ);
+    interpolator->attachAxis(0, xAxis);
+    interpolator->attachAxis(1, yAxis);
+}
+
+void tearDown()
+{
+    delete interpolator;
+    delete yAxis;
+    delete xAxis;
+}
+
+void test_line_lands_on_target()
+{
+    runMove(1000, 333);
+    TEST_ASSERT_EQUAL(1000, xAxis->currentPosition());
+    TEST_ASSERT_EQUAL(333, yAxis->currentPosition());
+
+    runMove(-250, 700);
+    TEST_ASSERT_EQUAL(750, xAxis->currentPosition());
+    TEST_ASSERT_EQUAL(1033, yAxis->currentPosition());
+}
+
+void test_trapezoid_cruises_at_the_axis_limit()
+{
+    long targets[2] = {4000, 0};
+    TEST_ASSERT_TRUE(interpolator->begin(targets, RATES, ACCELS));
+    float peak = 0;
+    while (interpolator->isActive())
+    {
+        interpolator->tick();
+        if (interpolator->getCurrentRate() > peak)
+        {
+            peak = interpolator->getCurrentRate();
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1000.0f, peak);
+    TEST_ASSERT_EQUAL(4000, xAxis->currentPosition());
+}
+
+void test_fixed_point_matches_float_profile()
+{
+    // 1000 steps/s after 0.2 s at 5000 steps/s^2 on a 4000 step line
+    long ticks = runMove(4000, 0);
+    FloatTick reference;
+    reference.axes[0] = xAxis;
+    reference.axes[1] = yAxis;
+    reference.begin(4000, 1000, 5000, sqrtf(5000 * 0.5f));
+    long referenceTicks = 1;
+    while (reference.tick())
+    {
+        referenceTicks++;
+    }
+    TEST_ASSERT_LESS_THAN(referenceTicks / 200, labs(ticks - referenceTicks));
+}
+
+void test_full_tick_rate_steps_every_tick()
+{
+    // Pulses timed inline allow a step on every tick, 2^32 in fixed point
+    const float rates[2] = {20000, 20000};
+    const float accels[2] = {1e8, 1e8};
+    long targets[2] = {2000, 1000};
+    TEST_ASSERT_TRUE(interpolator->begin(targets, rates, accels));
+    long ticks = 0;
+    while (interpolator->isActive() && ticks < 10000)
+    {
+        interpolator->tick();
+        ticks++;
+    }
+    TEST_ASSERT_EQUAL(2000, xAxis->currentPosition());
+    TEST_ASSERT_EQUAL(1000, yAxis->currentPosition());
+    TEST_ASSERT_LESS_THAN(2010, ticks);
+}
+
+void test_s_curve_lands_on_target()
+{
+    const float jerks[2] = {50000, 50000};
+    runMove(1000, 333, jerks);
+    TEST_ASSERT_EQUAL(1000, xAxis->currentPosition());
+    TEST_ASSERT_EQUAL(333, yAxis->currentPosition());
+}
+
+void test_s_curve_rate_changes_smoothly()
+{
+    // Limits along X alone: 1000 steps/s, 5000 steps/s^2, 50000 steps/s^3
+    const float jerks[2] = {50000, 50000};
+    const float tick = 1.0f / TICK_HZ;
+    long targets[2] = {4000, 0};
+    TEST_ASSERT_TRUE(interpolator->begin(targets, RATES, ACCELS, jerks));
+
+    float rate = interpolator->getCurrentRate();
+    float accel = 0;
+    float worstAccel = 0;
+    float worstJerk = 0;
+    while (interpolator->isActive())
+    {
+        interpolator->tick();
+        if (!interpolator->isActive())
+        {
+            break;  // Reads 0 once the last step is out
+        }
+        float nextRate = interpolator->getCurrentRate();
+        float nextAccel = (nextRate - rate) / tick;
+        worstAccel = fmaxf(worstAccel, fabsf(nextAccel));
+        worstJerk = fmaxf(worstJerk, fabsf(nextAccel - accel) / tick);
+        rate = nextRate;
+        accel = nextAccel;
+    }
+
+    // The rate reads back through 32-bit fixed point and a float, good to
+    // about 1e-4 steps/s, which is up to 2e4 steps/s^3 of apparent jerk
+    // at 10 kHz. A trapezoid would show 5e7 at each corner.
+    TEST_ASSERT_LESS_OR_EQUAL(5050, worstAccel);
+    TEST_ASSERT_LESS_OR_EQUAL(75000, worstJerk);
+}
+
+void test_planned_move_starts_only_where_planned()
+{
+    const float jerks[2] = {50000, 50000};
+    long starts[2] = {0, 0};
+    long targets[2] = {1000, 333};
+    Interpolator::Profile profile;
+    TEST_ASSERT_TRUE(interpolator->plan(profile, starts, targets, RATES,
+                                        ACCELS, jerks, 0, 0, 1));
+
+    xAxis->setCurrentPosition(1);
+    TEST_ASSERT_FALSE(interpolator->start(profile));
+    xAxis->setCurrentPosition(0);
+    TEST_ASSERT_TRUE(interpolator->start(profile));
+    long ticks = 0;
+    while (interpolator->isActive())
+    {
+        interpolator->tick();
+        ticks++;
+    }
+    TEST_ASSERT_EQUAL(1000, xAxis->currentPosition());
+    TEST_ASSERT_EQUAL(333, yAxis->currentPosition());
+
+    // Planned ahead or in begin(), the move runs the same
+    xAxis->setCurrentPosition(0);
+    yAxis->setCurrentPosition(0);
+    TEST_ASSERT_EQUAL(ticks, runMove(1000, 333, jerks));
+}
+
+void test_benchmark_step_cost()
+{
+    // Both loops are polled at the step timer rate through the same
+    // 4000 step move: here the axes' and the interpolator's tick(), there
+    // AccelStepper's run() against a clock that moves one tick per call.
+    // Host counts only compare the two; the RA4M1 has its own.
+    const int MOVES = 50;
+    const long STEPS = 4000;
+    const unsigned long TICK_MICROS = 1000000UL / TICK_HZ;
+    long targets[2] = {0, 0};
+    long steps = 0;
+    unsigned long long start = cycleStamp();
+    for (int i = 0; i < MOVES; i++)
+    {
+        long from = xAxis->currentPosition();
+        targets[0] = i % 2 ? 0 : STEPS;
+        interpolator->begin(targets, RATES, ACCELS);
+        do
+        {
+            xAxis->tick();
+            yAxis->tick();
+            interpolator->tick();
+        } while (interpolator->isActive());
+        steps += labs(xAxis->currentPosition() - from);
+    }
+    unsigned long long tickCycles = cycleStamp() - start;
+
+    AccelStepperLoop reference;
+    long referenceSteps = 0;
+    start = cycleStamp();
+    for (int i = 0; i < MOVES; i++)
+    {
+        hostMicros = 0;
+        reference.begin(STEPS, RATES[0], ACCELS[0]);
+        do
+        {
+            hostMicros += TICK_MICROS;
+        } while (reference.run());
+        referenceSteps += reference.currentPos;
+    }
+    unsigned long long referenceCycles = cycleStamp() - start;
+
+    char line[96];
+    snprintf(line, sizeof(line),
+             "per step: tick() path %.0f, AccelStepper run() %.0f %s",
+             static_cast<double>(tickCycles) / steps,
+             static_cast<double>(referenceCycles) / referenceSteps,
+#if defined(__x86_64__) || defined(__i386__)
+             "cycles");
+#else
+             "ns");
+#endif
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL(MOVES * STEPS, steps);
+    TEST_ASSERT_EQUAL(MOVES * STEPS, referenceSteps);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_line_lands_on_target);
+    RUN_TEST(test_trapezoid_cruises_at_the_axis_limit);
+    RUN_TEST(test_fixed_point_matches_float_profile);
+    RUN_TEST(test_full_tick_rate_steps_every_tick);
+    RUN_TEST(test_s_curve_lands_on_target);
+    RUN_TEST(test_s_curve_rate_changes_smoothly);
+    RUN_TEST(test_planned_move_starts_only_where_planned);
+    RUN_TEST(test_benchmark_step_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,119 @@
+// test_main.cpp
+// Host tests for the single producer, single consumer motion queue
+#include <unity.h>
+
+#include "MotionQueue.h"
+
+namespace
+{
+MotionSegment segmentTo(long x)
+{
+    MotionSegment segment = {};
+    segment.target[0] = x;
+    segment.target[1] = -x;
+    return segment;
+}
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_empty_queue_has_nothing_to_pop()
+{
+    MotionQueue queue;
+    MotionSegment segment = segmentTo(7);
+
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_FALSE(queue.isFull());
+    TEST_ASSERT_EQUAL(0, queue.size());
+    TEST_ASSERT_NULL(queue.peek());
+    TEST_ASSERT_FALSE(queue.pop(segment));
+    TEST_ASSERT_EQUAL(7, segment.target[0]);  // Left untouched
+}
+
+void test_full_queue_refuses_push()
+{
+    MotionQueue queue;
+    for (long i = 0; i < MotionQueue::CAPACITY; i++)
+    {
+        TEST_ASSERT_TRUE(queue.push(segmentTo(i)));
+    }
+
+    TEST_ASSERT_TRUE(queue.isFull());
+    TEST_ASSERT_EQUAL(MotionQueue::CAPACITY, queue.size());
+    TEST_ASSERT_FALSE(queue.push(segmentTo(99)));
+    TEST_ASSERT_EQUAL(MotionQueue::CAPACITY, queue.getHighWater());
+
+    // The refused segment must not have overwritten the oldest one
+    TEST_ASSERT_EQUAL(0, queue.peek()->target[0]);
+
+    MotionSegment segment;
+    TEST_ASSERT_TRUE(queue.pop(segment));
+    TEST_ASSERT_FALSE(queue.isFull());
+    TEST_ASSERT_TRUE(queue.push(segmentTo(99)));
+    TEST_ASSERT_EQUAL(99, queue.at(MotionQueue::CAPACITY - 1).target[0]);
+}
+
+void test_order_survives_index_wraparound()
+{
+    MotionQueue queue;
+    MotionSegment segment;
+    long nextIn = 0;
+    long nextOut = 0;
+
+    // Run well past 256 so the free-running uint8 head and tail wrap, with
+    // the queue kept part full so reads and writes straddle the wrap
+    for (int round = 0; round < 200; round++)
+    {
+        for (int i = 0; i < 3 && !queue.isFull(); i++)
+        {
+            TEST_ASSERT_TRUE(queue.push(segmentTo(nextIn++)));
+        }
+        for (uint8_t i = 0; i < queue.size(); i++)
+        {
+            TEST_ASSERT_EQUAL(nextOut + i, queue.at(i).target[0]);
+        }
+        for (int i = 0; i < 2 && queue.pop(segment); i++)
+        {
+            TEST_ASSERT_EQUAL(nextOut, segment.target[0]);
+            TEST_ASSERT_EQUAL(-nextOut, segment.target[1]);
+            nextOut++;
+        }
+        TEST_ASSERT_EQUAL(nextIn - nextOut, queue.size());
+    }
+
+    TEST_ASSERT_GREATER_THAN(256, nextOut);
+    while (queue.pop(segment))
+    {
+        TEST_ASSERT_EQUAL(nextOut++, segment.target[0]);
+    }
+    TEST_ASSERT_EQUAL(nextIn, nextOut);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+void test_clear_drops_pending_segments()
+{
+    MotionQueue queue;
+    queue.push(segmentTo(1));
+    queue.push(segmentTo(2));
+    queue.clear();
+
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_NULL(queue.peek());
+
+    queue.resetHighWater();
+    TEST_ASSERT_EQUAL(0, queue.getHighWater());
+    TEST_ASSERT_TRUE(queue.push(segmentTo(3)));
+    TEST_ASSERT_EQUAL(3, queue.peek()->target[0]);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_queue_has_nothing_to_pop);
+    RUN_TEST(test_full_queue_refuses_push);
+    RUN_TEST(test_order_survives_index_wraparound);
+    RUN_TEST(test_clear_drops_pending_segments);
+    return UNITY_END();
+}
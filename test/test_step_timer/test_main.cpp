@@ -0,0 +1,64 @@
+// test_main.cpp
+// Host tests for the simulated step timer backend
+#include <unity.h>
+
+#include "StepTimer.h"
+
+namespace
+{
+unsigned long fired = 0;
+
+void countTick() { fired++; }
+}  // namespace
+
+void setUp() { fired = 0; }
+
+void tearDown() {}
+
+void test_begin_rejects_bad_arguments()
+{
+    StepTimer timer;
+    TEST_ASSERT_FALSE(timer.begin(0, countTick));
+    TEST_ASSERT_FALSE(timer.begin(10000, nullptr));
+    TEST_ASSERT_FALSE(timer.isRunning());
+}
+
+void test_tick_fires_only_while_running()
+{
+    StepTimer timer;
+    timer.tick();
+    TEST_ASSERT_EQUAL(0, fired);
+
+    TEST_ASSERT_TRUE(timer.begin(10000, countTick));
+    TEST_ASSERT_EQUAL(100, timer.getPeriodMicros());
+    timer.tick();
+    timer.tick();
+    TEST_ASSERT_EQUAL(2, fired);
+    TEST_ASSERT_EQUAL(2, timer.getTickCount());
+
+    timer.end();
+    timer.tick();
+    TEST_ASSERT_EQUAL(2, fired);
+}
+
+void test_advance_carries_partial_periods()
+{
+    StepTimer timer;
+    TEST_ASSERT_TRUE(timer.begin(10000, countTick));
+
+    timer.advance(250);  // Two periods and half of the next
+    TEST_ASSERT_EQUAL(2, fired);
+    timer.advance(50);  // Completes the third
+    TEST_ASSERT_EQUAL(3, fired);
+    timer.advance(1000);
+    TEST_ASSERT_EQUAL(13, fired);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_rejects_bad_arguments);
+    RUN_TEST(test_tick_fires_only_while_running);
+    RUN_TEST(test_advance_carries_partial_periods);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+// test_main.cpp
+// Host tests for the step outputs and the driver timing of StepperAxis
+#include <unity.h>
+
+#include "StepperAxis.h"
+
+namespace
+{
+const uint8_t STEP_PIN = 2;
+const uint8_t DIR_PIN = 3;
+
+// Stand-in for one RA4M1 port's set and reset registers
+volatile uint16_t mockPOSR = 0;
+volatile uint16_t mockPORR = 0;
+
+// Runs one tick and returns how long it kept the interrupt busy
+unsigned long tickBusyMicros(StepperAxis& axis)
+{
+    unsigned long start = hostMicros;
+    axis.tick();
+    unsigned long busy = hostMicros - start;
+    hostMicros = start + 100;  // 10 kHz step timer
+    return busy;
+}
+}  // namespace
+
+void setUp()
+{
+    mockPOSR = 0;
+    mockPORR = 0;
+    hostMicros = 0;
+    memset(hostPins, 0, sizeof(hostPins));
+}
+
+void tearDown() {}
+
+void test_output_writes_only_its_mask_to_posr_and_porr()
+{
+    StepOutput output(&mockPOSR, &mockPORR, 1U << 5);
+    TEST_ASSERT_EQUAL_UINT16(0, mockPOSR);  // Starts low
+    TEST_ASSERT_EQUAL_UINT16(1U << 5, mockPORR);
+
+    mockPORR = 0;
+    output.set();
+    TEST_ASSERT_EQUAL_UINT16(1U << 5, mockPOSR);
+    TEST_ASSERT_EQUAL_UINT16(0, mockPORR);
+
+    mockPOSR = 0;
+    output.clear();
+    TEST_ASSERT_EQUAL_UINT16(0, mockPOSR);
+    TEST_ASSERT_EQUAL_UINT16(1U << 5, mockPORR);
+
+    mockPORR = 0;
+    output.write(true);
+    output.write(false);
+    TEST_ASSERT_EQUAL_UINT16(1U << 5, mockPOSR);
+    TEST_ASSERT_EQUAL_UINT16(1U << 5, mockPORR);
+}
+
+void test_default_timing_never_waits_inside_the_tick()
+{
+    StepperAxis axis(STEP_PIN, DIR_PIN);
+    axis.setDriverTiming(10, 5, 5);
+    axis.setMaxSpeed(5000);
+    axis.setAcceleration(1e7);
+
+    axis.moveTo(20);
+    for (int i = 0; i < 200 && axis.isRunning(); i++)
+    {
+        TEST_ASSERT_EQUAL(0, tickBusyMicros(axis));
+    }
+    axis.moveTo(0);  // Reverse, which needs the direction setup time
+    for (int i = 0; i < 200 && axis.isRunning(); i++)
+    {
+        TEST_ASSERT_EQUAL(0, tickBusyMicros(axis));
+    }
+    TEST_ASSERT_EQUAL(0, axis.currentPosition());
+    TEST_ASSERT_FALSE(axis.isRunning());
+}
+
+void test_short_pulses_stay_inline_and_bounded()
+{
+    StepperAxis axis(STEP_PIN, DIR_PIN);
+    axis.setDriverTiming(2, 1, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 10000.0f, axis.maxStepRate());
+    axis.setMaxSpeed(10000);
+    axis.setAcceleration(1e8);
+
+    axis.moveTo(-30);
+    for (int i = 0; i < 200 && axis.isRunning(); i++)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL(3, tickBusyMicros(axis));
+        TEST_ASSERT_EQUAL(LOW, hostPins[STEP_PIN]);  // Lowered in the tick
+    }
+    TEST_ASSERT_EQUAL(-30, axis.currentPosition());
+}
+
+void test_direction_change_steps_on_a_later_tick()
+{
+    StepperAxis axis(STEP_PIN, DIR_PIN);
+    axis.setDriverTiming(10, 5, 5);
+    axis.setMaxSpeed(5000);
+    axis.setAcceleration(1e7);
+
+    int dirBefore = hostPins[DIR_PIN];
+    axis.stepOnce(false);  // Reverses the direction pin, no pulse yet
+    TEST_ASSERT_TRUE(hostPins[DIR_PIN] != dirBefore);
+    TEST_ASSERT_EQUAL(LOW, hostPins[STEP_PIN]);
+    TEST_ASSERT_TRUE(axis.isRunning());  // The motor still owes the step
+
+    tickBusyMicros(axis);
+    TEST_ASSERT_EQUAL(HIGH, hostPins[STEP_PIN]);
+    tickBusyMicros(axis);
+    TEST_ASSERT_EQUAL(LOW, hostPins[STEP_PIN]);
+    TEST_ASSERT_FALSE(axis.isRunning());
+}
+
+void test_long_setup_and_hold_span_whole_ticks()
+{
+    StepperAxis axis(STEP_PIN, DIR_PIN);
+    axis.setDriverTiming(2, 250, 150);  // 3 and 2 ticks at 10 kHz
+
+    // The pulse goes out inline and starts the hold time
+    int dirBefore = hostPins[DIR_PIN];
+    axis.stepOnce(true);
+    TEST_ASSERT_EQUAL(dirBefore, hostPins[DIR_PIN]);
+    TEST_ASSERT_FALSE(axis.isRunning());
+
+    // Reversing waits out the hold, then the setup, before stepping
+    axis.stepOnce(false);
+    TEST_ASSERT_EQUAL(dirBefore, hostPins[DIR_PIN]);
+    tickBusyMicros(axis);
+    TEST_ASSERT_EQUAL(dirBefore, hostPins[DIR_PIN]);
+    tickBusyMicros(axis);
+    TEST_ASSERT_TRUE(hostPins[DIR_PIN] != dirBefore);
+    tickBusyMicros(axis);
+    tickBusyMicros(axis);
+    TEST_ASSERT_TRUE(axis.isRunning());
+    tickBusyMicros(axis);
+    TEST_ASSERT_FALSE(axis.isRunning());
+    TEST_ASSERT_EQUAL(0, axis.motorStepPosition());
+}
+
+void test_shaped_motor_trails_the_commanded_position()
+{
+    InputShaper shaper;
+    TEST_ASSERT_TRUE(shaper.configure(InputShaper::ZV, 10, 0.05f));
+    StepperAxis axis(STEP_PIN, DIR_PIN);
+    axis.setDriverTiming(2, 1, 1);
+    axis.setMaxSpeed(2000);
+    axis.setAcceleration(1e6);
+    axis.attachShaper(&shaper);
+
+    axis.moveTo(400);
+    for (int i = 0; i < 1000; i++)
+    {
+        tickBusyMicros(axis);
+    }
+    // At cruise, half the motion arrives half a period (50 ms) late, so the
+    // motor is 2000 steps/s * 25 ms behind
+    long lag = axis.currentPosition() - axis.motorStepPosition();
+    TEST_ASSERT_INT_WITHIN(5, 50, lag);
+
+    for (int i = 0; i < 2000 && axis.isRunning(); i++)
+    {
+        tickBusyMicros(axis);
+    }
+    TEST_ASSERT_EQUAL(400, axis.currentPosition());
+    TEST_ASSERT_EQUAL(400, axis.motorStepPosition());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_output_writes_only_its_mask_to_posr_and_porr);
+    RUN_TEST(test_default_timing_never_waits_inside_the_tick);
+    RUN_TEST(test_short_pulses_stay_inline_and_bounded);
+    RUN_TEST(test_direction_change_steps_on_a_later_tick);
+    RUN_TEST(test_long_setup_and_hold_span_whole_ticks);
+    RUN_TEST(test_shaped_motor_trails_the_commanded_position);
+    return UNITY_END();
+}